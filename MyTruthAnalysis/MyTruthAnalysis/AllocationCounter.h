@@ -0,0 +1,22 @@
+#ifndef MyTruthAnalysis_AllocationCounter_H
+#define MyTruthAnalysis_AllocationCounter_H
+
+#include <cstdint>
+
+namespace TruthAna
+{
+
+    /// Count of operator new calls on the calling thread.
+    /// Only an executable that replaces the global operator new and calls
+    /// countAllocation() from it feeds the count (runTruthAnalysis does);
+    /// allocationCounting() tells whether that is the case.
+    std::uint64_t threadAllocations();
+
+    bool allocationCounting();
+    void enableAllocationCounting();
+
+    /// to be called from the replacement operator new only
+    void countAllocation() noexcept;
+
+} // namespace TruthAna
+#endif
@@ -0,0 +1,43 @@
+#ifndef MyTruthAnalysis_CutExpressions_H
+#define MyTruthAnalysis_CutExpressions_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Named cut expressions over the observables of an analysis, e.g.
+    /// "Tight objects: TauVis0_pt > 40 && B0_pt > 80".
+    /// The expressions are compiled once by cling into native functions that read
+    /// the observables through their addresses, so evaluating a cut costs one call.
+    class CutExpressions
+    {
+    public:
+        using Function = bool (*)(const void *const *);
+
+    private:
+        std::vector<std::pair<std::string, std::string>> m_vObservables; // name, type
+        std::vector<const void *> m_vAddresses;
+        std::vector<std::string> m_vNames;
+        std::vector<Function> m_vFunctions;
+
+        void declareObservable(const std::string &sName, const std::string &sType, const void *address);
+
+    public:
+        void declareObservable(const std::string &sName, const double *address);
+        void declareObservable(const std::string &sName, const unsigned long long *address);
+
+        /// compiles "name: expression" strings (the name is optional and made of
+        /// words, '_' and '-'),
+        /// returns false and fills sError if one does not compile
+        bool compile(const std::vector<std::string> &vExpressions, std::string &sError);
+
+        std::size_t size() const { return m_vFunctions.size(); }
+        const std::string &name(std::size_t i) const { return m_vNames[i]; }
+        bool pass(std::size_t i) const { return m_vFunctions[i](m_vAddresses.data()); }
+    };
+
+} // namespace TruthAna
+#endif
@@ -9,11 +9,23 @@ class Cutflow
 {
 private:
     std::vector<std::pair<std::string, float>> m_vCutflow;
+    std::vector<float> m_vSumW2;
     std::map<std::string, std::size_t> m_mapIndex;
 public:
     Cutflow() : m_vCutflow({}){};
     void addCut(const std::string &sName, const float &fWeights);
+    /// fills an entry by its index, without any name look-up
+    void addCut(std::size_t iEntry, float fWeight)
+    {
+        m_vCutflow[iEntry].second += fWeight;
+        m_vSumW2[iEntry] += fWeight * fWeight;
+    }
+    /// index of an entry, added with zero weight if it does not exist yet
+    std::size_t index(const std::string &sName);
     void print() const;
+    /// sqrt(sum w^2) / sum w of an entry, 1 if it is not filled yet
+    double relativeError(const std::string &sName) const;
+    const std::vector<std::pair<std::string, float>> &entries() const { return m_vCutflow; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef MyTruthAnalysis_DecisionTrace_H
+#define MyTruthAnalysis_DecisionTrace_H
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Fixed-size summary of the selection decision of one event
+    struct DecisionRecord
+    {
+        std::uint64_t runNumber;
+        std::uint64_t eventNumber;
+        std::uint32_t conditions; // analysis specific bits
+        std::uint16_t cutsPassed; // index of the first failed cut
+        std::uint8_t flags;       // kTraced, kAccepted
+        std::uint8_t channel;
+        std::uint8_t nTaus;
+        std::uint8_t nJets;
+        std::uint8_t nFatJets;
+        std::uint8_t nBJets;
+        std::uint8_t reserved[4];
+
+        static constexpr std::uint8_t kTraced = 1;
+        static constexpr std::uint8_t kAccepted = 2;
+
+        /// object counts saturate at 255
+        static std::uint8_t count(std::size_t n) { return n > 255 ? 255 : static_cast<std::uint8_t>(n); }
+    };
+    static_assert(sizeof(DecisionRecord) == 32, "the trace file format relies on 32 byte records");
+
+    /// Binary per-event decision trace.
+    /// Records go into a single-producer single-consumer lock-free ring buffer and a
+    /// writer thread appends them to the trace file; if the writer falls behind the
+    /// records are dropped and counted, the event loop never waits.
+    /// File layout: "TADT", version, record size, 0 (4 x 32 bit), the records, then a
+    /// trailer with the cut and condition names and the number of dropped records, and finally the
+    /// 64 bit offset of the trailer and "TADE". share/DumpDecisionTrace.py prints it.
+    class DecisionTrace
+    {
+    private:
+        std::FILE *m_pFile = nullptr;
+        std::unique_ptr<DecisionRecord[]> m_pRing;
+        std::size_t m_nMask;
+        std::atomic<std::uint64_t> m_nHead{0};
+        std::atomic<std::uint64_t> m_nTail{0};
+        std::atomic<bool> m_bStop{false};
+        std::uint64_t m_nDropped = 0;
+        std::thread m_thread;
+
+        void run();
+        void flush();
+
+    public:
+        /// nCapacity is rounded up to a power of two
+        DecisionTrace(const std::string &sFileName, std::size_t nCapacity);
+        ~DecisionTrace();
+        DecisionTrace(const DecisionTrace &) = delete;
+        DecisionTrace &operator=(const DecisionTrace &) = delete;
+
+        bool good() const { return m_pFile != nullptr; }
+
+        void push(const DecisionRecord &record)
+        {
+            const std::uint64_t nHead = m_nHead.load(std::memory_order_relaxed);
+            if (nHead - m_nTail.load(std::memory_order_acquire) > m_nMask)
+            {
+                ++m_nDropped;
+                return;
+            }
+            m_pRing[nHead & m_nMask] = record;
+            m_nHead.store(nHead + 1, std::memory_order_release);
+        }
+
+        /// drains the buffer, writes the trailer and closes the file
+        void close(const std::vector<const char *> &vCutNames, const std::vector<const char *> &vConditionNames);
+    };
+
+} // namespace TruthAna
+#endif
@@ -0,0 +1,88 @@
+#ifndef MyTruthAnalysis_EventArena_H
+#define MyTruthAnalysis_EventArena_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Monotonic memory arena for per-event temporaries.
+    /// Memory is handed out linearly and only given back all at once by reset().
+    /// If an event needs more than the capacity, the extra memory comes from the
+    /// heap (counted as overflow allocations), and the next reset() grows the arena
+    /// so that the arena itself stops allocating once the event sizes are known.
+    class EventArena
+    {
+    private:
+        std::unique_ptr<char[]> m_pBuffer;
+        std::size_t m_nCapacity;
+        std::size_t m_nUsed = 0;
+        std::vector<std::unique_ptr<char[]>> m_vOverflow;
+        std::size_t m_nOverflowBytes = 0;
+        std::size_t m_nOverflowAllocs = 0;
+        std::size_t m_nTotalOverflowAllocs = 0;
+        std::size_t m_nEventsWithOverflow = 0;
+        std::size_t m_nPeakBytes = 0;
+
+    public:
+        explicit EventArena(std::size_t nCapacity);
+        EventArena(const EventArena &) = delete;
+        EventArena &operator=(const EventArena &) = delete;
+
+        void *allocate(std::size_t nBytes, std::size_t nAlign);
+        void reset();
+
+        std::size_t capacity() const { return m_nCapacity; }
+        /// bytes handed out since the last reset(), including heap overflow
+        std::size_t bytesUsed() const { return m_nUsed + m_nOverflowBytes; }
+        /// overflow allocations since the last reset()
+        std::size_t overflowAllocs() const { return m_nOverflowAllocs; }
+        std::size_t totalOverflowAllocs() const { return m_nTotalOverflowAllocs; }
+        std::size_t eventsWithOverflow() const { return m_nEventsWithOverflow; }
+        std::size_t peakBytes() const { return m_nPeakBytes; }
+    };
+
+    /// STL allocator drawing from an EventArena, deallocate is a no-op
+    template <typename T>
+    class ArenaAllocator
+    {
+    private:
+        EventArena *m_pArena;
+
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(EventArena &arena) noexcept : m_pArena(&arena) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_pArena(other.arena()) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(m_pArena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) noexcept {}
+
+        EventArena *arena() const noexcept { return m_pArena; }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+    {
+        return a.arena() == b.arena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+    {
+        return !(a == b);
+    }
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace TruthAna
+#endif
@@ -0,0 +1,25 @@
+#ifndef MyTruthAnalysis_EventList_H
+#define MyTruthAnalysis_EventList_H
+
+// std
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Reads the EventList trees of previous runs into sorted, unique entries per input file,
+    /// keyed on the full input file name as it was recorded.
+    /// Returns false and fills sError if a file has no EventList tree
+    bool readEventLists(const std::vector<std::string> &vFiles,
+                        std::map<std::string, std::vector<long long>> &mapEntries, std::string &sError);
+
+    /// Splits sorted entries into at most nMaxRanges [first, last] ranges, cutting at the largest
+    /// gaps, so that a replay only walks the entries between the selected ones that are close
+    std::vector<std::pair<long long, long long>> entryRanges(const std::vector<long long> &vEntries,
+                                                             std::size_t nMaxRanges);
+
+} // namespace TruthAna
+#endif
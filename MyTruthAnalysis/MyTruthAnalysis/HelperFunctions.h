@@ -3,9 +3,12 @@
 
 // xAOD
 #include <xAODTruth/TruthParticle.h>
+#include <xAODTruth/TruthEvent.h>
+#include <xAODTruth/TruthParticleContainer.h>
 #include <xAODJet/JetContainer.h>
 #include <xAODJet/Jet.h>
 #include <exception>
+#include <vector>
 
 namespace TruthAna
 {
@@ -16,12 +19,31 @@ namespace TruthAna
 
     constexpr float GeV = 1'000;
 
+    /// first child with the given |pdgId|, nullptr if there is none
+    const xAOD::TruthParticle *findChild(const xAOD::TruthParticle *parent, const int absPdgId);
+
     bool hasChild(const xAOD::TruthParticle *parent, const int absPdgId);
 
     bool hasChild(const xAOD::TruthParticle *parent, const int absPdgId, std::vector<unsigned int> &indices);
 
     bool isFromHiggs(const xAOD::TruthParticle *particle);
 
+    /// H -> X X with both children of the given |pdgId|
+    bool isHiggsDecay(const xAOD::TruthParticle *particle, const int absPdgId);
+
+    /// Looks for H -> tau tau and H -> b b in the first nMaxParticles particles of the
+    /// record (0 means the whole record).
+    /// Returns true if both are found.
+    bool findHiggsDecays(const xAOD::TruthEvent *event, std::size_t nMaxParticles,
+                         const xAOD::TruthParticle *&higgsTauTau, const xAOD::TruthParticle *&higgsBB);
+
+    /// same, from a slimmed container of bosons with their decays
+    bool findHiggsDecays(const xAOD::TruthParticleContainer *particles,
+                         const xAOD::TruthParticle *&higgsTauTau, const xAOD::TruthParticle *&higgsBB);
+
+    /// true if a Higgs of the container has lost its decay products (no or broken child links)
+    bool hasIncompleteHiggsDecay(const xAOD::TruthParticleContainer *particles);
+
     /// this uses TruthFlavour
     bool isBJet(const xAOD::Jet *jet);
 
@@ -32,16 +54,15 @@ namespace TruthAna
 
     bool isTauTruth(const xAOD::TruthParticle *tau);
 
-    bool contains(const std::vector<int> &v, const std::size_t &element);
-
-    std::string printVec(const std::vector<int> &v, const std::string &message);
-
     const xAOD::TruthParticle *getFinal(const xAOD::TruthParticle *particle);
 
     void getFinalHelper(const xAOD::TruthParticle *particle, xAOD::TruthParticle *&final);
 
     TLorentzVector tauVisP4(const xAOD::TruthParticle *tau);
 
+    /// deterministic selection of a fraction of the events, from a hash of the event number
+    bool isInSample(unsigned long long eventNumber, unsigned long long seed, double fraction);
+
     bool isGoodEvent(); // TODO
 
     bool isOS(const xAOD::TruthParticle *p0, const xAOD::TruthParticle *p1);
@@ -0,0 +1,78 @@
+#ifndef MyTruthAnalysis_JetPairing_H
+#define MyTruthAnalysis_JetPairing_H
+
+// xAOD
+#include <xAODBase/IParticle.h>
+
+// std
+#include <cstddef>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Picks the best pair out of a list of jets, scored against the truth partons or
+    /// against a mass hypothesis. The jet kinematics are cached once per jet, so the
+    /// scoring does not build any four-vectors and does not allocate per pair.
+    /// The storage is kept between events, call clear() and add() per event.
+    class JetPairing
+    {
+    public:
+        struct Pair
+        {
+            /// indices in the order the jets were added, first is the leading jet of the pair
+            int first = -1;
+            int second = -1;
+            double score = -1;
+            bool found() const { return first >= 0; }
+        };
+
+    private:
+        std::vector<double> m_vPt;
+        std::vector<double> m_vEta;
+        std::vector<double> m_vPhi;
+        std::vector<double> m_vM;
+        std::vector<double> m_vPx;
+        std::vector<double> m_vPy;
+        std::vector<double> m_vPz;
+        std::vector<double> m_vE;
+        std::vector<double> m_vMT;
+        std::vector<double> m_vY;
+        std::vector<double> m_vExpY;
+        std::vector<int> m_vOrder;
+        std::vector<double> m_vMinMT;
+        std::size_t m_nPairsScored = 0;
+
+        double pairMass(int i, int j) const;
+        Pair makePair(int i, int j, double score) const;
+
+    public:
+        void clear();
+        /// index of the jet is the order in which it was added
+        void add(const xAOD::IParticle *jet);
+        template <typename Container>
+        void addAll(const Container &jets)
+        {
+            for (const auto *jet : jets)
+                add(jet);
+        }
+
+        std::size_t size() const { return m_vPt.size(); }
+
+        /// Pair matched to the two partons, score = delta R(jet, p0) + delta R(jet, p1).
+        /// Each jet must be within maxDR of its parton. The pair score is separable,
+        /// so the best pair follows from the two closest jets of each parton in O(n).
+        Pair matchPartons(const xAOD::IParticle *p0, const xAOD::IParticle *p1, double maxDR) const;
+
+        /// Pair with the invariant mass closest to mass, score = |m(jj) - mass|.
+        /// Jets are visited in increasing rapidity. As m(jj)^2 >= 2 mT_a mT_b (cosh dy - 1),
+        /// the inner loop stops once the rapidity gap makes every further pair too heavy to
+        /// beat the best one; pairs with E_a + E_b too small to reach it are skipped.
+        Pair matchMass(double mass);
+
+        /// number of pairs whose mass the last matchMass() computed
+        std::size_t pairsScored() const { return m_nPairsScored; }
+    };
+
+} // namespace TruthAna
+#endif
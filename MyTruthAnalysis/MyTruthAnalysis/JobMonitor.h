@@ -0,0 +1,84 @@
+#ifndef MyTruthAnalysis_JobMonitor_H
+#define MyTruthAnalysis_JobMonitor_H
+
+// My class
+#include "MyTruthAnalysis/Cutflow.h"
+
+// std
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TruthAna
+{
+
+    /// Publishes the progress of a running job to a JSON status file.
+    /// A background thread wakes up every interval and writes the event rate
+    /// (overall, recent and for the current input file), the current and peak RSS,
+    /// the ETA and the cutflow. The file is replaced atomically, so it can be
+    /// polled at any time. The event loop only bumps counters in tick(), and hands
+    /// over a cutflow copy when the thread asked for one, so it never waits on the thread.
+    class JobMonitor
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::string m_sFileName;
+        std::chrono::milliseconds m_nInterval;
+        unsigned long long m_nTotalEvents;
+
+        std::atomic<unsigned long long> m_nEvents{0};
+        std::atomic<unsigned long long> m_nFileEvents{0};
+        std::atomic<bool> m_bCutflowRequested{false};
+
+        // shared with the monitor thread, guarded by m_mutex
+        std::mutex m_mutex;
+        std::vector<std::pair<std::string, float>> m_vCutflow;
+        std::string m_sInputFile;
+        unsigned long long m_nInputFileEntries = 0;
+        Clock::time_point m_tInputFileStart;
+
+        // monitor thread only
+        Clock::time_point m_tStart;
+        Clock::time_point m_tLastSample;
+        unsigned long long m_nLastEvents = 0;
+
+        std::thread m_thread;
+        std::condition_variable m_cvStop;
+        bool m_bStop = false;
+
+        void run();
+        void writeStatus(const char *sState);
+
+    public:
+        JobMonitor(const std::string &sFileName, double fIntervalSeconds, unsigned long long nTotalEvents);
+        ~JobMonitor();
+        JobMonitor(const JobMonitor &) = delete;
+        JobMonitor &operator=(const JobMonitor &) = delete;
+
+        void start();
+        /// stops the thread and writes the final status, with the final cutflow if given
+        void stop(const Cutflow *cutflow = nullptr);
+
+        /// to be called once per event
+        void tick(const Cutflow &cutflow)
+        {
+            m_nEvents.fetch_add(1, std::memory_order_relaxed);
+            m_nFileEvents.fetch_add(1, std::memory_order_relaxed);
+            if (m_bCutflowRequested.load(std::memory_order_relaxed))
+                publishCutflow(cutflow);
+        }
+
+        void setInputFile(const std::string &sName, unsigned long long nEntries);
+
+    private:
+        void publishCutflow(const Cutflow &cutflow);
+    };
+
+} // namespace TruthAna
+#endif
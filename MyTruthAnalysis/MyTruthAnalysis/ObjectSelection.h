@@ -0,0 +1,134 @@
+#ifndef MyTruthAnalysis_ObjectSelection_H
+#define MyTruthAnalysis_ObjectSelection_H
+
+// My class
+#include "MyTruthAnalysis/HelperFunctions.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace TruthAna
+{
+
+    double deltaPhi(double phi0, double phi1);
+
+    double deltaR(double eta0, double phi0, double eta1, double phi1);
+
+    /// Eta-phi grid for delta R neighbour queries.
+    /// Objects are put into cells of at least `cellSize` in eta and phi, so a query
+    /// only visits the cells around the query point instead of every object.
+    /// The storage is kept between events, call clear(), add() and build() per event.
+    class EtaPhiGrid
+    {
+    private:
+        double m_fCellSize;
+        double m_fEtaMax;
+        int m_nEtaCells;
+        int m_nPhiCells;
+        double m_fPhiCellSize;
+        std::vector<double> m_vEta;
+        std::vector<double> m_vPhi;
+        std::vector<int> m_vCell;
+        std::vector<std::size_t> m_vCellStart;
+        std::vector<std::size_t> m_vCellFill;
+        std::vector<std::size_t> m_vSorted;
+
+        int etaCell(double eta) const;
+        int phiCell(double phi) const;
+
+    public:
+        explicit EtaPhiGrid(double cellSize = 0.4, double etaMax = 5.0);
+
+        void clear();
+        /// index of the object is the order in which it was added
+        void add(double eta, double phi);
+        void add(const xAOD::IParticle *particle) { add(particle->eta(), particle->phi()); }
+        template <typename Container>
+        void addAll(const Container &particles)
+        {
+            for (const auto *p : particles)
+                add(p);
+        }
+        /// sorts the objects into cells, to be called before any query
+        void build();
+
+        std::size_t size() const { return m_vEta.size(); }
+
+        /// calls f(index) for each object with delta R < dR from (eta, phi)
+        template <typename F>
+        void forEachWithin(double eta, double phi, double dR, F &&f) const;
+
+        bool anyWithin(double eta, double phi, double dR) const;
+        bool anyWithin(const xAOD::IParticle *particle, double dR) const
+        {
+            return anyWithin(particle->eta(), particle->phi(), dR);
+        }
+    };
+
+    /// Bitset of object indices, replaces linear contains() look-ups
+    class IndexMask
+    {
+    private:
+        std::vector<std::uint64_t> m_vWords;
+
+    public:
+        /// clears the mask and makes room for indices [0, n)
+        void reset(std::size_t n) { m_vWords.assign((n + 63) / 64, 0); }
+        void insert(std::size_t i)
+        {
+            if (i / 64 >= m_vWords.size())
+                m_vWords.resize(i / 64 + 1, 0);
+            m_vWords[i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+        bool contains(std::size_t i) const
+        {
+            return i / 64 < m_vWords.size() && (m_vWords[i / 64] >> (i % 64)) & 1;
+        }
+    };
+
+    /// Moves the k highest pT objects to the front of v, in decreasing pT order.
+    /// Only those are sorted, the order of the rest is unspecified.
+    /// Returns the number of objects sorted, min(k, v.size())
+    template <typename Container>
+    std::size_t topKByPt(Container &v, std::size_t k)
+    {
+        const std::size_t n = std::min(k, static_cast<std::size_t>(v.size()));
+        std::partial_sort(v.begin(), v.begin() + n, v.end(),
+                          [](const xAOD::IParticle *a, const xAOD::IParticle *b) { return a->pt() > b->pt(); });
+        return n;
+    }
+
+    template <typename F>
+    void EtaPhiGrid::forEachWithin(double eta, double phi, double dR, F &&f) const
+    {
+        if (m_vEta.empty())
+            return;
+        const int nEtaReach = static_cast<int>(std::ceil(dR / m_fCellSize));
+        const int nPhiReach = static_cast<int>(std::ceil(dR / m_fPhiCellSize));
+        const int iEta = etaCell(eta);
+        const int iPhi = phiCell(phi);
+        // visit each phi cell once if the reach wraps all the way around
+        const bool bAllPhi = 2 * nPhiReach + 1 >= m_nPhiCells;
+        const int iPhiBegin = bAllPhi ? 0 : iPhi - nPhiReach;
+        const int iPhiEnd = bAllPhi ? m_nPhiCells - 1 : iPhi + nPhiReach;
+        for (int jEta = std::max(0, iEta - nEtaReach); jEta <= std::min(m_nEtaCells - 1, iEta + nEtaReach); ++jEta)
+        {
+            for (int kPhi = iPhiBegin; kPhi <= iPhiEnd; ++kPhi)
+            {
+                const int jPhi = (kPhi + m_nPhiCells) % m_nPhiCells;
+                const int iCell = jEta * m_nPhiCells + jPhi;
+                for (std::size_t k = m_vCellStart[iCell]; k != m_vCellStart[iCell + 1]; ++k)
+                {
+                    const std::size_t i = m_vSorted[k];
+                    if (deltaR(eta, phi, m_vEta[i], m_vPhi[i]) < dR)
+                        f(i);
+                }
+            }
+        }
+    }
+
+} // namespace TruthAna
+#endif
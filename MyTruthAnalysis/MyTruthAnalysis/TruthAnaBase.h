@@ -6,9 +6,19 @@
 
 // My class
 #include "MyTruthAnalysis/Cutflow.h"
+#include "MyTruthAnalysis/EventArena.h"
+#include "MyTruthAnalysis/CutExpressions.h"
+#include "MyTruthAnalysis/JobMonitor.h"
+#include "MyTruthAnalysis/DecisionTrace.h"
 
 // std
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TTree;
 
 class TruthAnaBase : public EL::AnaAlgorithm
 {
@@ -20,25 +30,161 @@ public:
   virtual StatusCode initialize() override;
   virtual StatusCode execute() override;
   virtual StatusCode finalize() override;
+  virtual StatusCode beginInputFile() override;
 
 protected:
   std::unique_ptr<Cutflow> m_cCutflow; //!
 
+  unsigned long long m_nProcessedEvents = 0; //!
+
+  /// arena for per-event temporaries, reset at the start of each execute()
+  std::unique_ptr<TruthAna::EventArena> m_cArena; //!
+
+  /// allocator for containers living in the event arena
+  template <typename T>
+  TruthAna::ArenaAllocator<T> arena() { return TruthAna::ArenaAllocator<T>(*m_cArena); }
+
+  /// books an output branch and makes it an observable for the CutExpressions
+  void bookBranch(TTree *tree, const std::string &sName, double *address);
+  void bookBranch(TTree *tree, const std::string &sName, unsigned long long *address);
+
+  /// compiles the CutExpressions, to be called once all branches are booked and the cuts
+  /// are declared with setCuts(), their names must differ from those of the cuts
+  StatusCode compileCutExpressions();
+
+  /// applies the compiled CutExpressions in order, filling the cutflow,
+  /// returns false at the first failed one
+  bool applyCutExpressions(float fWeight);
+
+  /// false for entries not in the ReplayEventLists, always true when not replaying
+  bool inEventList() const;
+
+  /// adds the current input entry to the EventList tree
+  void recordEvent(unsigned long long nRunNumber, unsigned long long nEventNumber);
+
+  /// decision of the current event, written to the DecisionTraceFile at the next event
+  TruthAna::DecisionRecord m_sDecision{}; //!
+
+  /// marks the event for the decision trace
+  void traceEvent(unsigned long long nRunNumber, unsigned long long nEventNumber)
+  {
+    m_sDecision.runNumber = nRunNumber;
+    m_sDecision.eventNumber = nEventNumber;
+    m_sDecision.flags |= TruthAna::DecisionRecord::kTraced;
+  }
+
+  /// names of the condition bits, in bit order, for the trace file
+  void setTraceConditions(const std::vector<const char *> &vNames) { m_vTraceConditionNames = vNames; }
+
+  void traceCondition(unsigned nBit, bool value)
+  {
+    m_sDecision.conditions |= static_cast<std::uint32_t>(value) << nBit;
+  }
+
+  /// names of the APPLYCUT cuts in the order they are applied, to be called in initialize();
+  /// the CutExpressions follow them
+  void setCuts(const std::vector<const char *> &vNames) { m_vCutNames = vNames; }
+
+  /// true if sName is a cut declared with setCuts() or a cut expression
+  bool hasCut(const std::string &sName) const;
+
+  /// called by APPLYCUT before testing the cut, false if it is not the cut declared at this
+  /// position; cutflow entries and trace bits are kept by position, so a cut applied only in
+  /// some events would shift all the following ones
+  bool traceCut(const char *sName)
+  {
+    const std::size_t iCut = m_sDecision.cutsPassed;
+    return (iCut < m_vCutSites.size() && m_vCutSites[iCut] == sName) || checkCut(sName);
+  }
+
+  /// called by APPLYCUT once the cut passed, fills its cutflow entry by index
+  void passCut(float fWeight) { m_cCutflow->addCut(m_vCutIndex[m_sDecision.cutsPassed++], fWeight); }
+
+  /// cutflow entry of an APPLYCOUNT name, looked up by the address of the literal
+  std::size_t countIndex(const char *sName)
+  {
+    auto it = m_mapCountIndex.find(sName);
+    if (it == m_mapCountIndex.end())
+      it = m_mapCountIndex.emplace(sName, m_cCutflow->index(std::string("[Count] ") + sName)).first;
+    return it->second;
+  }
+
+private:
+  bool checkCut(const char *sName);
+  const char *cutName(std::size_t iCut) const;
+  StatusCode restrictReadCache();
+  StatusCode readEventLists();
+
 private:
+  /// branches (wildcards allowed) the input TTreeCache is restricted to,
+  /// usually produced by a short read-statistics pass of the job script
+  std::vector<std::string> m_vCacheBranches;
+
+  /// initial size of the event arena in bytes, it grows if an event needs more
+  unsigned m_nArenaSize = 64 * 1024;
+
+  /// "name: expression" cuts over the booked branches, compiled at initialize()
+  std::vector<std::string> m_vCutExpressions;
+
+  TruthAna::CutExpressions m_cCutExpressions; //!
+
+  /// live job status, see TruthAna::JobMonitor
+  std::string m_sMonitorFile;
+  double m_fMonitorInterval = 10;
+  long long m_nMonitorTotalEvents = 0;
+
+  std::unique_ptr<TruthAna::JobMonitor> m_cMonitor; //!
+
+  long long m_nBytesReadAtStart = 0; //!
+
+  /// operator new calls of the event loop thread, when the executable counts them
+  unsigned long long m_nAllocsAtEvent = 0;      //!
+  unsigned long long m_nSteadyAllocs = 0;       //!
+  unsigned long long m_nEventsWithAllocs = 0;   //!
+
+  /// selected events of this run, and of a previous run to replay
+  bool m_bRecordEventList = true;
+  std::vector<std::string> m_vReplayEventLists;
+
+  TTree *m_cEventList = nullptr;                 //!
+  std::string m_sEventListFile;                  //!
+  long long m_nEventListEntry = 0;               //!
+  unsigned long long m_nEventListRun = 0;        //!
+  unsigned long long m_nEventListEvent = 0;      //!
+  std::map<std::string, std::vector<long long>> m_mapReplayEntries; //!
+  const std::vector<long long> *m_pReplayEntries = nullptr;        //!
+
+  /// binary decision trace, see TruthAna::DecisionTrace
+  std::string m_sDecisionTraceFile;
+  unsigned m_nDecisionTraceBuffer = 1 << 16;
+
+  std::unique_ptr<TruthAna::DecisionTrace> m_cDecisionTrace; //!
+  std::vector<const char *> m_vTraceConditionNames;          //!
+
+  /// declared cuts, and the name literal and cutflow entry of the cuts seen so far by position
+  std::vector<const char *> m_vCutNames;                         //!
+  std::vector<const char *> m_vCutSites;                         //!
+  std::vector<std::size_t> m_vCutIndex;                          //!
+  /// cutflow entries of the counters by name literal
+  std::unordered_map<const char *, std::size_t> m_mapCountIndex; //!
 };
 
 #endif
 
 #define APPLYCUT(criteria, name) \
+  if (!traceCut(name))           \
+  {                              \
+    return StatusCode::FAILURE;  \
+  }                              \
   if (!(criteria))                 \
   {                              \
     return StatusCode::SUCCESS;  \
   }                              \
-  m_cCutflow->addCut(name, m_fMCWeight);
+  passCut(m_fMCWeight);
 
 #define APPLYCOUNT(criteria, name) \
   if ((criteria))                 \
   {                              \
-    m_cCutflow->addCut(std::string("[Count] ") + name, m_fMCWeight);  \
+    m_cCutflow->addCut(countIndex(name), m_fMCWeight); \
   }
-  
\ No newline at end of file
+  
@@ -7,9 +7,13 @@
 // My class
 #include "MyTruthAnalysis/Cutflow.h"
 #include "MyTruthAnalysis/TruthAnaBase.h"
+#include "MyTruthAnalysis/ObjectSelection.h"
+#include "MyTruthAnalysis/JetPairing.h"
 
 // std
 #include <memory>
+#include <string>
+#include <vector>
 
 class TTree;
 
@@ -27,12 +31,81 @@ public:
   virtual StatusCode finalize() override;
 
 private:
+  /// bits of the decision trace conditions, named in initialize()
+  enum TraceBit : unsigned
+  {
+    TRACE_HIGGS_SLIMMED = 0,
+    TRACE_HIGGS_FALLBACK,
+    TRACE_OS_TAUS,
+    TRACE_OS_BS,
+    TRACE_GOOD_TAU0,
+    TRACE_GOOD_TAU1,
+    TRACE_GOOD_B0,
+    TRACE_GOOD_B1,
+    TRACE_NO_OVERLAP,
+    TRACE_STT,
+    TRACE_DTT,
+    TRACE_MTAUTAU
+  };
+
   void initBranches();
   void resetBranches();
+  bool reachedPrecision() const;
+
+private:
+  /// container of truth bosons with their decays (e.g. TruthBosonsWithDecayParticles), searched
+  /// before the full record; empty by default, the slimming differs between derivations
+  std::string m_sHiggsContainer = "";
+
+  /// the Higgs decays are searched in this many leading truth particles of the full record,
+  /// 0 for all of them. The default is 0 because no limit is safe for every generator: the
+  /// decaying Higgs copy can come after the shower (e.g. Herwig7), and a too small limit
+  /// silently drops signal events. Backgrounds are rejected cheaply through HiggsContainer
+  /// instead; set a limit only for samples whose record layout has been checked
+  unsigned m_nHardProcessScanLimit = 0;
+
+  /// object preselection and di-tau mass thresholds, in GeV; the CutExpressions are
+  /// applied after these, so loosen them here to study looser selections
+  double m_fTauPtMin = 20.;
+  double m_fTauEtaMax = 2.5;
+  double m_fBPtMin = 20.;
+  double m_fBEtaMax = 2.4;
+  double m_fMTauTauMin = 60.;
+  double m_fBTauOverlapDR = 0.2;
+
+  /// offline thresholds in GeV mimicking the single tau (STT) and di-tau (DTT) triggers
+  double m_fSTTTauPtMin = 100.;
+  double m_fSTTBPtMin = 45.;
+  double m_fDTTTau0PtMin = 40.;
+  double m_fDTTTau1PtMin = 30.;
+  double m_fDTTBPtMin = 80.;
+
+  /// deterministic prescale on the event number, weights are scaled up by 1 / fraction
+  double m_fSamplingFraction = 1.;
+  unsigned m_nSamplingSeed = 0;
+
+  /// stop once these cutflow entries have a relative statistical error below the target
+  double m_fEarlyStopPrecision = 0.;
+  std::vector<std::string> m_vEarlyStopCuts = {"Di-tau mass selection"};
+  unsigned m_nEarlyStopMinEvents = 1000;
+
+  /// resolved b-jet pair: "Truth" matches the b partons, "Mass" takes the pair closest to BjetPairingMass
+  std::string m_sBjetPairing = "Truth";
+  double m_fBjetPairingMaxDR = 0.4;
+  double m_fBjetPairingMass = 125.;
 
 private:
   TTree *m_cTree = nullptr;          //!
   CHAN m_eChannel = CHAN::UNKNOWN;   //!
+  bool m_bEarlyStopped = false;      //!
+  unsigned long long m_nInitialEvents = 0;      //!
+  unsigned long long m_nPrecisionCheckedAt = 0; //!
+  bool m_bPairByMass = false;        //!
+
+  // object selection helpers, kept to reuse their memory between events
+  TruthAna::EtaPhiGrid m_cTauGrid{1.0}; //!
+  TruthAna::IndexMask m_cDiBTagMask;    //!
+  TruthAna::JetPairing m_cJetPairing;   //!
 
 private:
   unsigned long long m_nEventNumber; //!
@@ -67,6 +140,7 @@ private:
   double m_fBjet1_phi;               //!
   double m_fBjet0_eta;               //!
   double m_fBjet1_eta;               //!
+  double m_fBjetPairScore;           //!
 
   // Large R jet
   double m_fDiBjet_pt;               //!
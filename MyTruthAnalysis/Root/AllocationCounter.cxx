@@ -0,0 +1,25 @@
+// My Class
+#include "MyTruthAnalysis/AllocationCounter.h"
+
+// std
+#include <atomic>
+
+namespace TruthAna
+{
+
+    namespace
+    {
+        // plain zero-initialised storage, safe to use from operator new before main()
+        thread_local std::uint64_t nThreadAllocations = 0;
+        std::atomic<bool> bCounting{false};
+    } // namespace
+
+    std::uint64_t threadAllocations() { return nThreadAllocations; }
+
+    bool allocationCounting() { return bCounting.load(std::memory_order_relaxed); }
+
+    void enableAllocationCounting() { bCounting.store(true, std::memory_order_relaxed); }
+
+    void countAllocation() noexcept { ++nThreadAllocations; }
+
+} // namespace TruthAna
@@ -0,0 +1,102 @@
+#include "MyTruthAnalysis/CutExpressions.h"
+
+// ROOT
+#include <TInterpreter.h>
+
+// std
+#include <cctype>
+#include <sstream>
+
+namespace TruthAna
+{
+
+    namespace
+    {
+        bool isNameChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == ' ' || c == '-';
+        }
+
+        /// position of the ':' after a leading name (words, '_' and '-'),
+        /// so that the ':' of a ternary or a '::' scope is never taken for it
+        std::size_t findNameSeparator(const std::string &s)
+        {
+            std::size_t i = s.find_first_not_of(" \t");
+            if (i == std::string::npos || !(std::isalpha(static_cast<unsigned char>(s[i])) || s[i] == '_'))
+                return std::string::npos;
+            while (i < s.size() && isNameChar(s[i]))
+                ++i;
+            if (i < s.size() && s[i] == ':' && (i + 1 == s.size() || s[i + 1] != ':'))
+                return i;
+            return std::string::npos;
+        }
+
+        std::string trim(const std::string &s)
+        {
+            const std::size_t iBegin = s.find_first_not_of(" \t");
+            if (iBegin == std::string::npos)
+                return "";
+            return s.substr(iBegin, s.find_last_not_of(" \t") - iBegin + 1);
+        }
+    } // namespace
+
+    void CutExpressions::declareObservable(const std::string &sName, const std::string &sType, const void *address)
+    {
+        m_vObservables.push_back(std::make_pair(sName, sType));
+        m_vAddresses.push_back(address);
+    }
+
+    void CutExpressions::declareObservable(const std::string &sName, const double *address)
+    {
+        declareObservable(sName, "double", address);
+    }
+
+    void CutExpressions::declareObservable(const std::string &sName, const unsigned long long *address)
+    {
+        declareObservable(sName, "unsigned long long", address);
+    }
+
+    bool CutExpressions::compile(const std::vector<std::string> &vExpressions, std::string &sError)
+    {
+        // unique names, several algorithms may compile cuts in the same process
+        static unsigned nFunctions = 0;
+
+        for (const std::string &sCut : vExpressions)
+        {
+            const std::size_t iSep = findNameSeparator(sCut);
+            const std::string sExpr = trim(iSep == std::string::npos ? sCut : sCut.substr(iSep + 1));
+            const std::string sName = iSep == std::string::npos ? sExpr : trim(sCut.substr(0, iSep));
+            const std::string sFunction = "cut" + std::to_string(nFunctions++);
+
+            std::ostringstream code;
+            code << "#include <cmath>\n"
+                 << "namespace TruthAnaCutExpressions {\n"
+                 << "bool " << sFunction << "(const void *const *obs) {\n";
+            for (std::size_t i = 0; i < m_vObservables.size(); ++i)
+            {
+                code << "  const " << m_vObservables[i].second << " &" << m_vObservables[i].first
+                     << " = *static_cast<const " << m_vObservables[i].second << " *>(obs[" << i << "]);\n";
+            }
+            code << "  return (" << sExpr << ");\n"
+                 << "}\n}\n";
+
+            if (!gInterpreter->Declare(code.str().c_str()))
+            {
+                sError = "cannot compile cut \"" + sName + "\": " + sExpr;
+                return false;
+            }
+            TInterpreter::EErrorCode eError = TInterpreter::kNoError;
+            const Long_t address = gInterpreter->Calc(("&TruthAnaCutExpressions::" + sFunction).c_str(), &eError);
+            if (eError != TInterpreter::kNoError || address == 0)
+            {
+                sError = "cannot find the compiled cut \"" + sName + "\"";
+                return false;
+            }
+
+            m_vNames.push_back(sName);
+            m_vFunctions.push_back(reinterpret_cast<Function>(address));
+        }
+        return true;
+    }
+
+} // namespace TruthAna
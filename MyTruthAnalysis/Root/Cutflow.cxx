@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <cmath>
 
 using std::cout;
 using std::setw;
@@ -13,15 +14,37 @@ void Cutflow::addCut(const std::string &sName, const float &fWeights)
 {
     if (m_mapIndex.find(sName) != m_mapIndex.end()) 
     {
-        m_vCutflow[m_mapIndex[sName]].second += fWeights;
+        const size_t i = m_mapIndex[sName];
+        m_vCutflow[i].second += fWeights;
+        m_vSumW2[i] += fWeights * fWeights;
     }
     else
     {
         m_vCutflow.push_back(std::make_pair(sName, fWeights));
+        m_vSumW2.push_back(fWeights * fWeights);
         m_mapIndex[sName] = m_vCutflow.size() - 1;
     }
 }
 
+std::size_t Cutflow::index(const std::string &sName)
+{
+    auto it = m_mapIndex.find(sName);
+    if (it != m_mapIndex.end())
+        return it->second;
+    m_vCutflow.push_back(std::make_pair(sName, 0.f));
+    m_vSumW2.push_back(0.f);
+    m_mapIndex[sName] = m_vCutflow.size() - 1;
+    return m_vCutflow.size() - 1;
+}
+
+double Cutflow::relativeError(const std::string &sName) const
+{
+    auto it = m_mapIndex.find(sName);
+    if (it == m_mapIndex.end() || m_vCutflow[it->second].second <= 0)
+        return 1.;
+    return std::sqrt(m_vSumW2[it->second]) / m_vCutflow[it->second].second;
+}
+
 void Cutflow::print() const
 {
     cout << "Printing cutflow\n";
@@ -34,14 +57,22 @@ void Cutflow::print() const
 
     cout << std::left << setw(5) << "idx " << std::left << setw(nLongestP2) 
          << "Name" << std::left << setw(10) << "SumW" << "Rel. Eff.\n";
+    // relative efficiencies are w.r.t. the previous cut, skipping the counters
+    const std::pair<std::string, float> *pPrevCut = nullptr;
     for (size_t i = 0; i < m_vCutflow.size(); ++i)
     {
         cout << "(" << std::left << setw(2) << i + 1  << ") "
              << std::left << setw(nLongestP2) << m_vCutflow[i].first 
              << std::left << setw(10) << m_vCutflow[i].second;
-        if (i > 0 && m_vCutflow[i].first.find("Count") == std::string::npos)
-            cout << m_vCutflow[i].second / m_vCutflow[i - 1].second << '\n';
+        if (m_vCutflow[i].first.find("Count") != std::string::npos)
+        {
+            cout << '\n';
+            continue;
+        }
+        if (pPrevCut && pPrevCut->second != 0)
+            cout << m_vCutflow[i].second / pPrevCut->second << '\n';
         else
             cout << '\n';
+        pPrevCut = &m_vCutflow[i];
     }
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "MyTruthAnalysis/DecisionTrace.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace TruthAna
+{
+
+    namespace
+    {
+        constexpr std::uint32_t nVersion = 1;
+
+        template <typename T>
+        void writeValue(std::FILE *pFile, const T &value)
+        {
+            std::fwrite(&value, sizeof(T), 1, pFile);
+        }
+
+        /// 32 bit count, then 16 bit length and characters of each name
+        void writeNames(std::FILE *pFile, const std::vector<const char *> &vNames)
+        {
+            writeValue(pFile, static_cast<std::uint32_t>(vNames.size()));
+            for (const char *sName : vNames)
+            {
+                const std::uint16_t nLength = std::strlen(sName);
+                writeValue(pFile, nLength);
+                std::fwrite(sName, 1, nLength, pFile);
+            }
+        }
+    } // namespace
+
+    DecisionTrace::DecisionTrace(const std::string &sFileName, std::size_t nCapacity)
+    {
+        std::size_t n = 1;
+        while (n < nCapacity)
+            n <<= 1;
+        m_pRing.reset(new DecisionRecord[n]);
+        m_nMask = n - 1;
+
+        m_pFile = std::fopen(sFileName.c_str(), "wb");
+        if (!m_pFile)
+            return;
+        std::fwrite("TADT", 1, 4, m_pFile);
+        writeValue(m_pFile, nVersion);
+        writeValue(m_pFile, static_cast<std::uint32_t>(sizeof(DecisionRecord)));
+        writeValue(m_pFile, std::uint32_t(0));
+        m_thread = std::thread(&DecisionTrace::run, this);
+    }
+
+    DecisionTrace::~DecisionTrace()
+    {
+        close({}, {});
+    }
+
+    void DecisionTrace::run()
+    {
+        while (!m_bStop.load(std::memory_order_acquire))
+        {
+            flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    void DecisionTrace::flush()
+    {
+        const std::uint64_t nTail = m_nTail.load(std::memory_order_relaxed);
+        const std::uint64_t nHead = m_nHead.load(std::memory_order_acquire);
+        if (nHead == nTail)
+            return;
+        // at most two contiguous pieces of the ring
+        const std::size_t iBegin = nTail & m_nMask;
+        const std::size_t nFirst = std::min<std::uint64_t>(nHead - nTail, m_nMask + 1 - iBegin);
+        std::fwrite(&m_pRing[iBegin], sizeof(DecisionRecord), nFirst, m_pFile);
+        if (nFirst < nHead - nTail)
+            std::fwrite(&m_pRing[0], sizeof(DecisionRecord), nHead - nTail - nFirst, m_pFile);
+        m_nTail.store(nHead, std::memory_order_release);
+    }
+
+    void DecisionTrace::close(const std::vector<const char *> &vCutNames, const std::vector<const char *> &vConditionNames)
+    {
+        if (!m_pFile)
+            return;
+        m_bStop.store(true, std::memory_order_release);
+        if (m_thread.joinable())
+            m_thread.join();
+        flush();
+
+        const std::uint64_t nTrailer = std::ftell(m_pFile);
+        writeNames(m_pFile, vCutNames);
+        writeNames(m_pFile, vConditionNames);
+        writeValue(m_pFile, m_nDropped);
+        writeValue(m_pFile, nTrailer);
+        std::fwrite("TADE", 1, 4, m_pFile);
+        std::fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+
+} // namespace TruthAna
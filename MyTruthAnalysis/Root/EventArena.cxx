@@ -0,0 +1,65 @@
+#include "MyTruthAnalysis/EventArena.h"
+
+// std
+#include <algorithm>
+#include <cstdint>
+
+namespace TruthAna
+{
+
+    namespace
+    {
+        char *alignUp(char *p, std::size_t nAlign)
+        {
+            const std::uintptr_t n = reinterpret_cast<std::uintptr_t>(p);
+            return reinterpret_cast<char *>((n + nAlign - 1) & ~(std::uintptr_t(nAlign) - 1));
+        }
+    } // namespace
+
+    EventArena::EventArena(std::size_t nCapacity)
+        : m_pBuffer(new char[nCapacity]), m_nCapacity(nCapacity)
+    {
+        m_vOverflow.reserve(16);
+    }
+
+    void *EventArena::allocate(std::size_t nBytes, std::size_t nAlign)
+    {
+        char *pBegin = m_pBuffer.get();
+        char *p = alignUp(pBegin + m_nUsed, nAlign);
+        if (p + nBytes <= pBegin + m_nCapacity)
+        {
+            m_nUsed = (p - pBegin) + nBytes;
+            return p;
+        }
+
+        // does not fit, take it from the heap until the next reset
+        m_vOverflow.emplace_back(new char[nBytes + nAlign]);
+        m_nOverflowBytes += nBytes + nAlign;
+        ++m_nOverflowAllocs;
+        return alignUp(m_vOverflow.back().get(), nAlign);
+    }
+
+    void EventArena::reset()
+    {
+        const std::size_t nBytes = bytesUsed();
+        m_nPeakBytes = std::max(m_nPeakBytes, nBytes);
+        m_nTotalOverflowAllocs += m_nOverflowAllocs;
+        if (m_nOverflowAllocs > 0)
+        {
+            ++m_nEventsWithOverflow;
+        }
+
+        if (!m_vOverflow.empty())
+        {
+            // grow once so that an event of this size fits next time
+            m_vOverflow.clear();
+            m_nCapacity = std::max(2 * m_nCapacity, 2 * nBytes);
+            m_pBuffer.reset(new char[m_nCapacity]);
+        }
+
+        m_nUsed = 0;
+        m_nOverflowBytes = 0;
+        m_nOverflowAllocs = 0;
+    }
+
+} // namespace TruthAna
@@ -0,0 +1,79 @@
+// My Class
+#include "MyTruthAnalysis/EventList.h"
+
+// ROOT
+#include <TChain.h>
+
+// std
+#include <algorithm>
+
+namespace TruthAna
+{
+
+    bool readEventLists(const std::vector<std::string> &vFiles,
+                        std::map<std::string, std::vector<long long>> &mapEntries, std::string &sError)
+    {
+        TChain chain("EventList");
+        for (const std::string &sFile : vFiles)
+        {
+            if (chain.Add(sFile.c_str(), -1) == 0)
+            {
+                sError = "No EventList tree in " + sFile;
+                return false;
+            }
+        }
+
+        std::string *pFile = nullptr;
+        long long nEntry = 0;
+        chain.SetBranchAddress("File", &pFile);
+        chain.SetBranchAddress("Entry", &nEntry);
+        for (Long64_t i = 0; chain.GetEntry(i) > 0; ++i)
+        {
+            mapEntries[*pFile].push_back(nEntry);
+        }
+        chain.ResetBranchAddresses();
+        delete pFile;
+
+        for (auto &p : mapEntries)
+        {
+            std::sort(p.second.begin(), p.second.end());
+            p.second.erase(std::unique(p.second.begin(), p.second.end()), p.second.end());
+        }
+        return true;
+    }
+
+    std::vector<std::pair<long long, long long>> entryRanges(const std::vector<long long> &vEntries,
+                                                             std::size_t nMaxRanges)
+    {
+        std::vector<std::pair<long long, long long>> vRanges;
+        if (vEntries.empty())
+            return vRanges;
+
+        // a cut at i splits between entries i - 1 and i, keep the largest gaps
+        std::vector<std::size_t> vCuts;
+        for (std::size_t i = 1; i < vEntries.size(); ++i)
+        {
+            if (vEntries[i] - vEntries[i - 1] > 1)
+                vCuts.push_back(i);
+        }
+        const std::size_t nCuts = std::min(vCuts.size(), nMaxRanges > 0 ? nMaxRanges - 1 : 0);
+        std::partial_sort(vCuts.begin(), vCuts.begin() + nCuts, vCuts.end(),
+                          [&vEntries](std::size_t a, std::size_t b)
+                          {
+                              const long long nGapA = vEntries[a] - vEntries[a - 1], nGapB = vEntries[b] - vEntries[b - 1];
+                              return nGapA != nGapB ? nGapA > nGapB : a < b;
+                          });
+        vCuts.resize(nCuts);
+        std::sort(vCuts.begin(), vCuts.end());
+
+        std::size_t iBegin = 0;
+        for (std::size_t iCut : vCuts)
+        {
+            vRanges.emplace_back(vEntries[iBegin], vEntries[iCut - 1]);
+            iBegin = iCut;
+        }
+        vRanges.emplace_back(vEntries[iBegin], vEntries.back());
+        return vRanges;
+    }
+
+} // namespace TruthAna
@@ -17,7 +17,7 @@ using namespace TruthAna;
 namespace TruthAna
 {
 
-    bool hasChild(const xAOD::TruthParticle *parent, const int absPdgId)
+    const xAOD::TruthParticle *findChild(const xAOD::TruthParticle *parent, const int absPdgId)
     {
         const std::size_t nChildren = parent->nChildren();
         for (std::size_t iChild = 0; iChild != nChildren; ++iChild)
@@ -25,10 +25,15 @@ namespace TruthAna
             const xAOD::TruthParticle *child = parent->child(iChild);
             if (child && (absPdgId == child->absPdgId()))
             {
-                return true;
+                return child;
             }
         }
-        return false;
+        return nullptr;
+    }
+
+    bool hasChild(const xAOD::TruthParticle *parent, const int absPdgId)
+    {
+        return findChild(parent, absPdgId) != nullptr;
     }
 
     bool hasChild(const xAOD::TruthParticle *parent, const int absPdgId, std::vector<unsigned> &indices)
@@ -52,6 +57,75 @@ namespace TruthAna
         return (particle->auxdata<unsigned>("classifierParticleOrigin") == 14);
     }
 
+    bool isHiggsDecay(const xAOD::TruthParticle *particle, const int absPdgId)
+    {
+        if (particle->pdgId() != 25 || particle->nChildren() != 2)
+            return false;
+        const xAOD::TruthParticle *child0 = particle->child(0);
+        const xAOD::TruthParticle *child1 = particle->child(1);
+        return child0 && child1 && child0->absPdgId() == absPdgId && child1->absPdgId() == absPdgId;
+    }
+
+    bool findHiggsDecays(const xAOD::TruthEvent *event, std::size_t nMaxParticles,
+                         const xAOD::TruthParticle *&higgsTauTau, const xAOD::TruthParticle *&higgsBB)
+    {
+        higgsTauTau = nullptr;
+        higgsBB = nullptr;
+        std::size_t nParticles = event->nTruthParticles();
+        if (nMaxParticles > 0)
+            nParticles = std::min(nParticles, nMaxParticles);
+
+        for (std::size_t i = 0; i < nParticles; i++)
+        {
+            const xAOD::TruthParticle *particle = event->truthParticle(i);
+            if (!particle || particle->pdgId() != 25)
+                continue;
+            if (!higgsTauTau && isHiggsDecay(particle, 15))
+                higgsTauTau = particle;
+            else if (!higgsBB && isHiggsDecay(particle, 5))
+                higgsBB = particle;
+            if (higgsTauTau && higgsBB)
+                return true;
+        }
+        return false;
+    }
+
+    bool findHiggsDecays(const xAOD::TruthParticleContainer *particles,
+                         const xAOD::TruthParticle *&higgsTauTau, const xAOD::TruthParticle *&higgsBB)
+    {
+        higgsTauTau = nullptr;
+        higgsBB = nullptr;
+        for (const xAOD::TruthParticle *particle : *particles)
+        {
+            if (!particle || particle->pdgId() != 25)
+                continue;
+            if (!higgsTauTau && isHiggsDecay(particle, 15))
+                higgsTauTau = particle;
+            else if (!higgsBB && isHiggsDecay(particle, 5))
+                higgsBB = particle;
+            if (higgsTauTau && higgsBB)
+                return true;
+        }
+        return false;
+    }
+
+    bool hasIncompleteHiggsDecay(const xAOD::TruthParticleContainer *particles)
+    {
+        for (const xAOD::TruthParticle *particle : *particles)
+        {
+            if (!particle || particle->pdgId() != 25)
+                continue;
+            if (particle->nChildren() == 0)
+                return true;
+            for (std::size_t i = 0; i < particle->nChildren(); ++i)
+            {
+                if (!particle->child(i))
+                    return true;
+            }
+        }
+        return false;
+    }
+
     bool isBJet(const xAOD::Jet *jet)
     {
         return (jet->auxdata<int>("TrueFlavor") == 5);
@@ -75,23 +149,6 @@ namespace TruthAna
         return (tau->absPdgId() == 15);
     }
 
-    bool contains(const std::vector<int> &v, const std::size_t &element)
-    {
-        return std::count(v.begin(), v.end(), element);
-    }
-
-    std::string printVec(const std::vector<int> &v, const std::string &message)
-    {
-        std::string s = message + " { ";
-        for (int e : v)
-        {
-            s += std::to_string(e);
-            s += " ";
-        }
-        s += "}";
-        return std::move(s);
-    }
-
     const xAOD::TruthParticle *getFinal(const xAOD::TruthParticle *particle)
     {
         xAOD::TruthParticle *final = nullptr;
@@ -101,10 +158,9 @@ namespace TruthAna
 
     void getFinalHelper(const xAOD::TruthParticle *particle, xAOD::TruthParticle *&final)
     {
-        std::vector<unsigned> idx{};
-        if (hasChild(particle, particle->absPdgId(), idx))
+        if (const xAOD::TruthParticle *child = findChild(particle, particle->absPdgId()))
         {
-            getFinalHelper(particle->child(idx[0]), final);
+            getFinalHelper(child, final);
         }
         else
         {
@@ -115,11 +171,10 @@ namespace TruthAna
     TLorentzVector tauVisP4(const xAOD::TruthParticle *tau)
     {
         TLorentzVector tau_vis{};
-        std::vector<unsigned> idx{};
 
-        if (hasChild(tau, 16, idx))
+        if (const xAOD::TruthParticle *nu = findChild(tau, 16))
         { // 16 ->vt
-            tau_vis = tau->p4() - tau->child(idx[0])->p4();
+            tau_vis = tau->p4() - nu->p4();
         }
         else
         {
@@ -129,6 +184,16 @@ namespace TruthAna
         return tau_vis;
     }
 
+    bool isInSample(unsigned long long eventNumber, unsigned long long seed, double fraction)
+    {
+        // splitmix64 finaliser, uniform in [0, 1) from the top 53 bits
+        unsigned long long x = eventNumber + seed * 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        x = x ^ (x >> 31);
+        return (x >> 11) * (1. / (1ULL << 53)) < fraction;
+    }
+
     bool isGoodEvent()
     {
         // no cut
@@ -0,0 +1,157 @@
+// My Class
+#include "MyTruthAnalysis/JetPairing.h"
+#include "MyTruthAnalysis/ObjectSelection.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace TruthAna
+{
+
+    void JetPairing::clear()
+    {
+        m_vPt.clear();
+        m_vEta.clear();
+        m_vPhi.clear();
+        m_vM.clear();
+        m_vPx.clear();
+        m_vPy.clear();
+        m_vPz.clear();
+        m_vE.clear();
+        m_vMT.clear();
+        m_vY.clear();
+        m_vExpY.clear();
+    }
+
+    void JetPairing::add(const xAOD::IParticle *jet)
+    {
+        const double pt = jet->pt(), eta = jet->eta(), phi = jet->phi(), m = jet->m();
+        m_vPt.push_back(pt);
+        m_vEta.push_back(eta);
+        m_vPhi.push_back(phi);
+        m_vM.push_back(m);
+        m_vPx.push_back(pt * std::cos(phi));
+        m_vPy.push_back(pt * std::sin(phi));
+        m_vPz.push_back(pt * std::sinh(eta));
+        m_vE.push_back(std::sqrt(m_vPx.back() * m_vPx.back() + m_vPy.back() * m_vPy.back() +
+                                 m_vPz.back() * m_vPz.back() + m * m));
+        // E = mT cosh(y), pz = mT sinh(y)
+        m_vMT.push_back(std::sqrt(pt * pt + m * m));
+        m_vY.push_back(std::asinh(m_vPz.back() / m_vMT.back()));
+        m_vExpY.push_back(std::exp(m_vY.back()));
+    }
+
+    double JetPairing::pairMass(int i, int j) const
+    {
+        const double e = m_vE[i] + m_vE[j];
+        const double px = m_vPx[i] + m_vPx[j], py = m_vPy[i] + m_vPy[j], pz = m_vPz[i] + m_vPz[j];
+        return std::sqrt(std::max(0., e * e - px * px - py * py - pz * pz));
+    }
+
+    JetPairing::Pair JetPairing::makePair(int i, int j, double score) const
+    {
+        Pair pair;
+        pair.first = m_vPt[i] >= m_vPt[j] ? i : j;
+        pair.second = m_vPt[i] >= m_vPt[j] ? j : i;
+        pair.score = score;
+        return pair;
+    }
+
+    JetPairing::Pair JetPairing::matchPartons(const xAOD::IParticle *p0, const xAOD::IParticle *p1, double maxDR) const
+    {
+        // the best and second best jet for each parton, min over a != b of dR0[a] + dR1[b]
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        double dR0[2] = {inf, inf}, dR1[2] = {inf, inf};
+        int i0[2] = {-1, -1}, i1[2] = {-1, -1};
+        for (int i = 0; i < static_cast<int>(size()); ++i)
+        {
+            const double d0 = deltaR(m_vEta[i], m_vPhi[i], p0->eta(), p0->phi());
+            if (d0 < maxDR && d0 < dR0[1])
+            {
+                const int k = d0 < dR0[0] ? 0 : 1;
+                if (k == 0)
+                {
+                    dR0[1] = dR0[0];
+                    i0[1] = i0[0];
+                }
+                dR0[k] = d0;
+                i0[k] = i;
+            }
+            const double d1 = deltaR(m_vEta[i], m_vPhi[i], p1->eta(), p1->phi());
+            if (d1 < maxDR && d1 < dR1[1])
+            {
+                const int k = d1 < dR1[0] ? 0 : 1;
+                if (k == 0)
+                {
+                    dR1[1] = dR1[0];
+                    i1[1] = i1[0];
+                }
+                dR1[k] = d1;
+                i1[k] = i;
+            }
+        }
+
+        if (i0[0] < 0 || i1[0] < 0)
+            return Pair();
+        if (i0[0] != i1[0])
+            return makePair(i0[0], i1[0], dR0[0] + dR1[0]);
+        // both partons prefer the same jet, one of them takes its second choice
+        const double score0 = i1[1] >= 0 ? dR0[0] + dR1[1] : inf;
+        const double score1 = i0[1] >= 0 ? dR0[1] + dR1[0] : inf;
+        if (score0 == inf && score1 == inf)
+            return Pair();
+        return score0 <= score1 ? makePair(i0[0], i1[1], score0) : makePair(i0[1], i1[0], score1);
+    }
+
+    JetPairing::Pair JetPairing::matchMass(double mass)
+    {
+        m_nPairsScored = 0;
+        const int n = static_cast<int>(size());
+        if (n < 2)
+            return Pair();
+
+        m_vOrder.resize(n);
+        for (int i = 0; i < n; ++i)
+            m_vOrder[i] = i;
+        std::sort(m_vOrder.begin(), m_vOrder.end(), [this](int a, int b) { return m_vY[a] < m_vY[b]; });
+        // smallest mT from each position of the rapidity ordering to the end
+        m_vMinMT.resize(n);
+        m_vMinMT[n - 1] = m_vMT[m_vOrder[n - 1]];
+        for (int b = n - 2; b >= 0; --b)
+            m_vMinMT[b] = std::min(m_vMinMT[b + 1], m_vMT[m_vOrder[b]]);
+
+        // m(jj)^2 = m_a^2 + m_b^2 + 2 (mT_a mT_b cosh dy - pT_a pT_b cos dphi)
+        //        >= m_a^2 + 2 mT_a mT_b (cosh dy - 1),
+        // with mT_b bounded by the smallest mT still to come this only grows along the inner
+        // loop: once it reaches (mass + best score)^2, no later partner can come closer.
+        // On the light side m(jj) <= E_a + E_b, such pairs are skipped.
+        Pair best;
+        double bestScore = std::numeric_limits<double>::infinity();
+        for (int a = 0; a + 1 < n; ++a)
+        {
+            const int i = m_vOrder[a];
+            for (int b = a + 1; b < n; ++b)
+            {
+                const int j = m_vOrder[b];
+                const double maxMass = mass + bestScore;
+                // 2 cosh(y_j - y_i) from the cached exp(y), without a cosh per pair
+                const double fTwoCosh = m_vExpY[j] / m_vExpY[i] + m_vExpY[i] / m_vExpY[j];
+                if (m_vM[i] * m_vM[i] + m_vMT[i] * m_vMinMT[b] * (fTwoCosh - 2) >= maxMass * maxMass)
+                    break;
+                if (m_vE[i] + m_vE[j] <= mass - bestScore)
+                    continue;
+                ++m_nPairsScored;
+                const double score = std::abs(pairMass(i, j) - mass);
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    best = makePair(i, j, score);
+                }
+            }
+        }
+        return best;
+    }
+
+} // namespace TruthAna
@@ -0,0 +1,179 @@
+#include "MyTruthAnalysis/JobMonitor.h"
+
+// std
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+// system
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace TruthAna
+{
+
+    namespace
+    {
+        double currentRssMB()
+        {
+            long nPages = 0, nResident = 0;
+            std::ifstream statm("/proc/self/statm");
+            if (!(statm >> nPages >> nResident))
+                return 0;
+            return nResident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+        }
+
+        double peakRssMB()
+        {
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+                return 0;
+            return usage.ru_maxrss / 1024.; // kB on Linux
+        }
+
+        std::string jsonString(const std::string &s)
+        {
+            std::string sOut = "\"";
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\')
+                    sOut += '\\';
+                sOut += c;
+            }
+            return sOut + "\"";
+        }
+
+        double seconds(std::chrono::steady_clock::duration d)
+        {
+            return std::chrono::duration<double>(d).count();
+        }
+    } // namespace
+
+    JobMonitor::JobMonitor(const std::string &sFileName, double fIntervalSeconds, unsigned long long nTotalEvents)
+        : m_sFileName(sFileName),
+          m_nInterval(static_cast<long>(fIntervalSeconds * 1000)),
+          m_nTotalEvents(nTotalEvents)
+    {
+    }
+
+    JobMonitor::~JobMonitor()
+    {
+        stop();
+    }
+
+    void JobMonitor::start()
+    {
+        m_tStart = m_tLastSample = m_tInputFileStart = Clock::now();
+        m_thread = std::thread(&JobMonitor::run, this);
+    }
+
+    void JobMonitor::stop(const Cutflow *cutflow)
+    {
+        if (!m_thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvStop.notify_one();
+        m_thread.join();
+        if (cutflow)
+            m_vCutflow = cutflow->entries();
+        writeStatus("finished");
+    }
+
+    void JobMonitor::setInputFile(const std::string &sName, unsigned long long nEntries)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sInputFile = sName;
+        m_nInputFileEntries = nEntries;
+        m_tInputFileStart = Clock::now();
+        m_nFileEvents.store(0, std::memory_order_relaxed);
+    }
+
+    void JobMonitor::publishCutflow(const Cutflow &cutflow)
+    {
+        // never wait for the monitor thread, try again next event
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return;
+        // entries are only ever appended, so the names are copied when new ones show up,
+        // otherwise only the weights are updated in place, without allocating
+        const std::vector<std::pair<std::string, float>> &vEntries = cutflow.entries();
+        if (m_vCutflow.size() != vEntries.size())
+            m_vCutflow = vEntries;
+        else
+            for (std::size_t i = 0; i < vEntries.size(); ++i)
+                m_vCutflow[i].second = vEntries[i].second;
+        m_bCutflowRequested.store(false, std::memory_order_relaxed);
+    }
+
+    void JobMonitor::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_cvStop.wait_for(lock, m_nInterval, [this] { return m_bStop; }))
+        {
+            lock.unlock();
+            writeStatus("running");
+            // the copy shows up in the next status
+            m_bCutflowRequested.store(true, std::memory_order_relaxed);
+            lock.lock();
+        }
+    }
+
+    void JobMonitor::writeStatus(const char *sState)
+    {
+        const Clock::time_point tNow = Clock::now();
+        const unsigned long long nEvents = m_nEvents.load(std::memory_order_relaxed);
+        const unsigned long long nFileEvents = m_nFileEvents.load(std::memory_order_relaxed);
+        const double fElapsed = seconds(tNow - m_tStart);
+        const double fSinceLast = seconds(tNow - m_tLastSample);
+        const double fRate = fElapsed > 0 ? nEvents / fElapsed : 0;
+        const double fRecentRate = fSinceLast > 0 ? (nEvents - m_nLastEvents) / fSinceLast : 0;
+        m_tLastSample = tNow;
+        m_nLastEvents = nEvents;
+
+        std::ostringstream json;
+        json << "{\n"
+             << "  \"state\": " << jsonString(sState) << ",\n"
+             << "  \"time\": " << std::time(nullptr) << ",\n"
+             << "  \"elapsed_s\": " << fElapsed << ",\n"
+             << "  \"events\": " << nEvents << ",\n"
+             << "  \"events_per_s\": " << fRate << ",\n"
+             << "  \"recent_events_per_s\": " << fRecentRate << ",\n";
+        if (m_nTotalEvents > 0)
+        {
+            json << "  \"total_events\": " << m_nTotalEvents << ",\n"
+                 << "  \"eta_s\": " << (fRate > 0 && m_nTotalEvents > nEvents ? (m_nTotalEvents - nEvents) / fRate : 0) << ",\n";
+        }
+        json << "  \"rss_mb\": " << currentRssMB() << ",\n"
+             << "  \"peak_rss_mb\": " << peakRssMB() << ",\n";
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const double fFileElapsed = seconds(tNow - m_tInputFileStart);
+            json << "  \"input_file\": " << jsonString(m_sInputFile) << ",\n"
+                 << "  \"input_file_entries\": " << m_nInputFileEntries << ",\n"
+                 << "  \"input_file_events\": " << nFileEvents << ",\n"
+                 << "  \"input_file_events_per_s\": " << (fFileElapsed > 0 ? nFileEvents / fFileElapsed : 0) << ",\n"
+                 << "  \"cutflow\": [";
+            for (std::size_t i = 0; i < m_vCutflow.size(); ++i)
+            {
+                json << (i ? ",\n" : "\n") << "    {\"name\": " << jsonString(m_vCutflow[i].first)
+                     << ", \"sumw\": " << m_vCutflow[i].second << "}";
+            }
+            json << "\n  ]\n}\n";
+        }
+
+        // write aside and rename, readers never see a partial file
+        const std::string sTmp = m_sFileName + ".tmp";
+        {
+            std::ofstream out(sTmp);
+            out << json.str();
+            if (!out)
+                return;
+        }
+        std::rename(sTmp.c_str(), m_sFileName.c_str());
+    }
+
+} // namespace TruthAna
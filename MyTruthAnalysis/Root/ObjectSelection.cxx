@@ -0,0 +1,94 @@
+// My Class
+#include "MyTruthAnalysis/ObjectSelection.h"
+
+// ROOT
+#include <TMath.h>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace TruthAna
+{
+
+    double deltaPhi(double phi0, double phi1)
+    {
+        double dPhi = std::fmod(phi0 - phi1, 2 * TMath::Pi());
+        if (dPhi > TMath::Pi())
+            dPhi -= 2 * TMath::Pi();
+        else if (dPhi <= -TMath::Pi())
+            dPhi += 2 * TMath::Pi();
+        return dPhi;
+    }
+
+    double deltaR(double eta0, double phi0, double eta1, double phi1)
+    {
+        const double dEta = eta0 - eta1;
+        const double dPhi = deltaPhi(phi0, phi1);
+        return std::sqrt(dEta * dEta + dPhi * dPhi);
+    }
+
+    EtaPhiGrid::EtaPhiGrid(double cellSize, double etaMax)
+        : m_fCellSize(cellSize), m_fEtaMax(etaMax)
+    {
+        m_nEtaCells = std::max(1, static_cast<int>(std::ceil(2 * etaMax / cellSize)));
+        m_nPhiCells = std::max(1, static_cast<int>(std::floor(2 * TMath::Pi() / cellSize)));
+        m_fPhiCellSize = 2 * TMath::Pi() / m_nPhiCells;
+        m_vCellStart.assign(m_nEtaCells * m_nPhiCells + 1, 0);
+        m_vCellFill.assign(m_nEtaCells * m_nPhiCells, 0);
+    }
+
+    int EtaPhiGrid::etaCell(double eta) const
+    {
+        // objects beyond etaMax go to the edge cells, which keeps the search exact
+        const int i = static_cast<int>(std::floor((eta + m_fEtaMax) / m_fCellSize));
+        return std::min(std::max(i, 0), m_nEtaCells - 1);
+    }
+
+    int EtaPhiGrid::phiCell(double phi) const
+    {
+        double phi0 = std::fmod(phi, 2 * TMath::Pi());
+        if (phi0 < 0)
+            phi0 += 2 * TMath::Pi();
+        return std::min(static_cast<int>(phi0 / m_fPhiCellSize), m_nPhiCells - 1);
+    }
+
+    void EtaPhiGrid::clear()
+    {
+        m_vEta.clear();
+        m_vPhi.clear();
+        m_vCell.clear();
+        m_vSorted.clear();
+        std::fill(m_vCellStart.begin(), m_vCellStart.end(), 0);
+    }
+
+    void EtaPhiGrid::add(double eta, double phi)
+    {
+        m_vEta.push_back(eta);
+        m_vPhi.push_back(phi);
+        m_vCell.push_back(etaCell(eta) * m_nPhiCells + phiCell(phi));
+    }
+
+    void EtaPhiGrid::build()
+    {
+        // counting sort of the objects by cell
+        std::fill(m_vCellStart.begin(), m_vCellStart.end(), 0);
+        for (int iCell : m_vCell)
+            ++m_vCellStart[iCell + 1];
+        for (std::size_t i = 1; i < m_vCellStart.size(); ++i)
+            m_vCellStart[i] += m_vCellStart[i - 1];
+
+        std::copy(m_vCellStart.begin(), m_vCellStart.end() - 1, m_vCellFill.begin());
+        m_vSorted.resize(m_vCell.size());
+        for (std::size_t i = 0; i < m_vCell.size(); ++i)
+            m_vSorted[m_vCellFill[m_vCell[i]]++] = i;
+    }
+
+    bool EtaPhiGrid::anyWithin(double eta, double phi, double dR) const
+    {
+        bool found = false;
+        forEachWithin(eta, phi, dR, [&found](std::size_t) { found = true; });
+        return found;
+    }
+
+} // namespace TruthAna
@@ -4,12 +4,19 @@
 // ROOT
 #include <TLorentzVector.h>
 #include <TH1.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TTreeCache.h>
 
 // My headers
 #include "MyTruthAnalysis/TruthAnaBase.h"
 #include "MyTruthAnalysis/HelperFunctions.h"
+#include "MyTruthAnalysis/AllocationCounter.h"
+#include "MyTruthAnalysis/EventList.h"
 
 // std
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 using namespace TruthAna;
@@ -19,19 +26,339 @@ TruthAnaBase::TruthAnaBase(const std::string &name,
     : EL::AnaAlgorithm(name, pSvcLocator)
 {
   m_cCutflow = std::make_unique<Cutflow>();
+
+  declareProperty("CacheBranches", m_vCacheBranches,
+                  "Input branches to keep in the TTreeCache, empty means let the cache learn");
+  declareProperty("ArenaSize", m_nArenaSize,
+                  "Initial size in bytes of the per-event arena for temporaries");
+  declareProperty("CutExpressions", m_vCutExpressions,
+                  "Extra cuts as \"name: expression\" over the output branches, e.g. \"Tight: TauVis0_pt > 40\"");
+  declareProperty("MonitorFile", m_sMonitorFile,
+                  "JSON file the job status is written to periodically, empty to disable");
+  declareProperty("MonitorInterval", m_fMonitorInterval,
+                  "Seconds between two updates of the MonitorFile");
+  declareProperty("MonitorTotalEvents", m_nMonitorTotalEvents,
+                  "Expected number of events for the ETA in the MonitorFile, 0 if unknown");
+  declareProperty("RecordEventList", m_bRecordEventList,
+                  "Write the (file, entry, run, event) of the selected events to an EventList tree");
+  declareProperty("ReplayEventLists", m_vReplayEventLists,
+                  "Output files of a previous run, only the entries in their EventList trees are processed; "
+                  "the steering runs only the recorded input files and entry ranges (--replay)");
+  declareProperty("DecisionTraceFile", m_sDecisionTraceFile,
+                  "Binary file with one decision record per event, empty to disable");
+  declareProperty("DecisionTraceBuffer", m_nDecisionTraceBuffer,
+                  "Number of records buffered for the DecisionTraceFile writer");
 }
 
 StatusCode TruthAnaBase::initialize()
 {
+  if (!m_vCacheBranches.empty() || !m_sMonitorFile.empty() || !m_vReplayEventLists.empty())
+  {
+    ANA_CHECK(requestBeginInputFile());
+  }
+  m_nBytesReadAtStart = TFile::GetFileBytesRead();
+  m_cArena = std::make_unique<EventArena>(m_nArenaSize);
+
+  if (!m_sMonitorFile.empty())
+  {
+    if (!(m_fMonitorInterval > 0))
+    {
+      ANA_MSG_ERROR("MonitorInterval must be positive, got " << m_fMonitorInterval);
+      return StatusCode::FAILURE;
+    }
+    m_cMonitor = std::make_unique<JobMonitor>(m_sMonitorFile, m_fMonitorInterval, m_nMonitorTotalEvents);
+    m_cMonitor->start();
+    ANA_MSG_INFO("Writing job status to " << m_sMonitorFile << " every " << m_fMonitorInterval << " s");
+  }
+
+  if (m_bRecordEventList)
+  {
+    ANA_CHECK(book(TTree("EventList", "selected events")));
+    m_cEventList = tree("EventList");
+    m_cEventList->Branch("File", &m_sEventListFile);
+    m_cEventList->Branch("Entry", &m_nEventListEntry);
+    m_cEventList->Branch("RunNumber", &m_nEventListRun);
+    m_cEventList->Branch("EventNumber", &m_nEventListEvent);
+  }
+  if (!m_vReplayEventLists.empty())
+  {
+    ANA_CHECK(readEventLists());
+  }
+  if (!m_sDecisionTraceFile.empty())
+  {
+    m_cDecisionTrace = std::make_unique<DecisionTrace>(m_sDecisionTraceFile, m_nDecisionTraceBuffer);
+    if (!m_cDecisionTrace->good())
+    {
+      ANA_MSG_ERROR("Cannot open the decision trace file " << m_sDecisionTraceFile);
+      return StatusCode::FAILURE;
+    }
+  }
+
   return StatusCode::SUCCESS;
 }
 
 StatusCode TruthAnaBase::execute()
 {
+  if (TruthAna::allocationCounting())
+  {
+    // everything between two calls: the framework, the input reading and the analysis,
+    // the first event is left out as it fills all the caches
+    const unsigned long long nAllocs = TruthAna::threadAllocations() - m_nAllocsAtEvent;
+    if (m_nProcessedEvents > 1)
+    {
+      m_nSteadyAllocs += nAllocs;
+      m_nEventsWithAllocs += nAllocs > 0;
+    }
+    m_nAllocsAtEvent = TruthAna::threadAllocations();
+  }
+  if (m_nProcessedEvents > 0)
+  {
+    ANA_MSG_DEBUG("Event arena: " << m_cArena->bytesUsed() << " bytes, "
+                  << m_cArena->overflowAllocs() << " arena overflow allocations in previous event");
+  }
+  m_cArena->reset();
+  ++m_nProcessedEvents;
+  if (m_cDecisionTrace && (m_sDecision.flags & DecisionRecord::kTraced))
+  {
+    m_cDecisionTrace->push(m_sDecision);
+  }
+  m_sDecision = DecisionRecord{};
+  if (m_cMonitor)
+  {
+    m_cMonitor->tick(*m_cCutflow);
+  }
   return StatusCode::SUCCESS;
 }
 
 StatusCode TruthAnaBase::finalize()
 {
+  if (TruthAna::allocationCounting() && m_nProcessedEvents > 1)
+  {
+    // the last event ends here
+    const unsigned long long nAllocs = TruthAna::threadAllocations() - m_nAllocsAtEvent;
+    m_nSteadyAllocs += nAllocs;
+    m_nEventsWithAllocs += nAllocs > 0;
+  }
+  if (m_cMonitor)
+  {
+    m_cMonitor->stop(m_cCutflow.get());
+  }
+  if (m_cDecisionTrace)
+  {
+    if (m_sDecision.flags & DecisionRecord::kTraced)
+      m_cDecisionTrace->push(m_sDecision);
+    std::vector<const char *> vCutNames;
+    for (std::size_t i = 0; cutName(i); ++i)
+      vCutNames.push_back(cutName(i));
+    m_cDecisionTrace->close(vCutNames, m_vTraceConditionNames);
+    ANA_MSG_INFO("Wrote the decision trace to " << m_sDecisionTraceFile);
+  }
+
+  const long long nBytesRead = TFile::GetFileBytesRead() - m_nBytesReadAtStart;
+  ANA_MSG_INFO("Read " << nBytesRead << " bytes in " << m_nProcessedEvents << " events ("
+               << (m_nProcessedEvents ? nBytesRead / m_nProcessedEvents : 0) << " bytes/event)");
+
+  // account for the last event too
+  m_cArena->reset();
+  ANA_MSG_INFO("Event arena: capacity " << m_cArena->capacity() << " bytes, peak " << m_cArena->peakBytes()
+               << " bytes, " << m_cArena->totalOverflowAllocs() << " arena overflow allocations in "
+               << m_cArena->eventsWithOverflow() << " of " << m_nProcessedEvents << " events");
+  if (TruthAna::allocationCounting() && m_nProcessedEvents > 1)
+  {
+    ANA_MSG_INFO("Heap allocations after the first event: " << m_nSteadyAllocs << " in "
+                 << m_nEventsWithAllocs << " of " << m_nProcessedEvents - 1 << " events");
+  }
+  else if (!TruthAna::allocationCounting())
+  {
+    // no counting operator new in this process (e.g. a python steering), say so rather than print nothing
+    ANA_MSG_INFO("Heap allocations after the first event: allocation counting unavailable");
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+StatusCode TruthAnaBase::beginInputFile()
+{
+  if (!m_vReplayEventLists.empty())
+  {
+    auto it = m_mapReplayEntries.find(wk()->inputFile()->GetName());
+    m_pReplayEntries = it != m_mapReplayEntries.end() ? &it->second : nullptr;
+  }
+  if (m_cMonitor)
+  {
+    m_cMonitor->setInputFile(wk()->inputFile()->GetName(), wk()->inputFileNumEntries());
+  }
+  if (!m_vCacheBranches.empty())
+  {
+    ANA_CHECK(restrictReadCache());
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+StatusCode TruthAnaBase::restrictReadCache()
+{
+  TTree *tree = wk()->tree();
+  TTreeCache *cache = tree ? tree->GetReadCache(wk()->inputFile()) : nullptr;
+  if (!cache)
+  {
+    ANA_MSG_WARNING("No TTreeCache on the input tree, CacheBranches is ignored");
+    return StatusCode::SUCCESS;
+  }
+
+  // replace the learning phase by the known list of branches
+  std::size_t nAdded = 0;
+  for (const std::string &sBranch : m_vCacheBranches)
+  {
+    if (cache->AddBranch(sBranch.c_str(), true) < 0)
+      ANA_MSG_WARNING("CacheBranches entry " << sBranch << " is not a branch of " << tree->GetName());
+    else
+      ++nAdded;
+  }
+  if (nAdded == 0)
+  {
+    // a cache without branches would read every basket one by one, keep learning instead
+    ANA_MSG_WARNING("No CacheBranches entry matched, the TTreeCache keeps its learning phase");
+    return StatusCode::SUCCESS;
+  }
+  cache->StopLearningPhase();
+  ANA_MSG_INFO("Restricted TTreeCache to " << nAdded << " of " << m_vCacheBranches.size() << " branches");
+
+  return StatusCode::SUCCESS;
+}
+
+void TruthAnaBase::bookBranch(TTree *tree, const std::string &sName, double *address)
+{
+  tree->Branch(sName.c_str(), address);
+  m_cCutExpressions.declareObservable(sName, address);
+}
+
+void TruthAnaBase::bookBranch(TTree *tree, const std::string &sName, unsigned long long *address)
+{
+  tree->Branch(sName.c_str(), address);
+  m_cCutExpressions.declareObservable(sName, address);
+}
+
+StatusCode TruthAnaBase::compileCutExpressions()
+{
+  if (m_vCutExpressions.empty())
+    return StatusCode::SUCCESS;
+
+  std::string sError;
+  if (!m_cCutExpressions.compile(m_vCutExpressions, sError))
+  {
+    ANA_MSG_ERROR(sError);
+    return StatusCode::FAILURE;
+  }
+  for (std::size_t i = 0; i < m_cCutExpressions.size(); ++i)
+  {
+    // the cutflow has one entry per name, a repeated name would silently share it
+    const std::string &sName = m_cCutExpressions.name(i);
+    for (std::size_t j = 0; j < m_vCutNames.size() + i; ++j)
+    {
+      if (sName != cutName(j))
+        continue;
+      ANA_MSG_ERROR("Cut expression name \"" << sName << "\" is already used by "
+                    << (j < m_vCutNames.size() ? "a cut of the analysis" : "another cut expression")
+                    << ", give it a different name");
+      return StatusCode::FAILURE;
+    }
+    ANA_MSG_INFO("Compiled cut expression \"" << sName << "\"");
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+bool TruthAnaBase::applyCutExpressions(float fWeight)
+{
+  for (std::size_t i = 0; i < m_cCutExpressions.size(); ++i)
+  {
+    if (!traceCut(m_cCutExpressions.name(i).c_str()) || !m_cCutExpressions.pass(i))
+      return false;
+    passCut(fWeight);
+  }
+  return true;
+}
+
+const char *TruthAnaBase::cutName(std::size_t iCut) const
+{
+  if (iCut < m_vCutNames.size())
+    return m_vCutNames[iCut];
+  if (iCut - m_vCutNames.size() < m_cCutExpressions.size())
+    return m_cCutExpressions.name(iCut - m_vCutNames.size()).c_str();
+  return nullptr;
+}
+
+bool TruthAnaBase::hasCut(const std::string &sName) const
+{
+  for (std::size_t i = 0; cutName(i); ++i)
+  {
+    if (sName == cutName(i))
+      return true;
+  }
+  return false;
+}
+
+bool TruthAnaBase::checkCut(const char *sName)
+{
+  const std::size_t iCut = m_sDecision.cutsPassed;
+  const char *sExpected = cutName(iCut);
+  if (!sExpected || std::strcmp(sExpected, sName) != 0)
+  {
+    ANA_MSG_ERROR("Cut \"" << sName << "\" is applied at position " << iCut << ", where "
+                  << (sExpected ? "\"" + std::string(sExpected) + "\"" : std::string("no cut"))
+                  << " is declared; cuts must be applied in the order given to setCuts() in every event");
+    return false;
+  }
+  if (iCut == m_vCutSites.size())
+  {
+    // first event reaching this cut
+    m_vCutSites.push_back(sName);
+    m_vCutIndex.push_back(m_cCutflow->index(sName));
+  }
+  else
+  {
+    // the same name from another literal
+    m_vCutSites[iCut] = sName;
+  }
+  return true;
+}
+
+bool TruthAnaBase::inEventList() const
+{
+  if (m_vReplayEventLists.empty())
+    return true;
+  return m_pReplayEntries && std::binary_search(m_pReplayEntries->begin(), m_pReplayEntries->end(), wk()->treeEntry());
+}
+
+void TruthAnaBase::recordEvent(unsigned long long nRunNumber, unsigned long long nEventNumber)
+{
+  if (!m_cEventList)
+    return;
+  // only changes with the input file, the assignment does not reallocate in between
+  m_sEventListFile = wk()->inputFile()->GetName();
+  m_nEventListEntry = wk()->treeEntry();
+  m_nEventListRun = nRunNumber;
+  m_nEventListEvent = nEventNumber;
+  m_cEventList->Fill();
+}
+
+StatusCode TruthAnaBase::readEventLists()
+{
+  // keyed on the full input name, the replay jobs of both steerings read the files recorded there
+  std::string sError;
+  if (!TruthAna::readEventLists(m_vReplayEventLists, m_mapReplayEntries, sError))
+  {
+    ANA_MSG_ERROR(sError);
+    return StatusCode::FAILURE;
+  }
+
+  std::size_t nEntries = 0;
+  for (const auto &p : m_mapReplayEntries)
+  {
+    nEntries += p.second.size();
+  }
+  ANA_MSG_INFO("Replaying " << nEntries << " events from " << m_mapReplayEntries.size() << " input files");
+
   return StatusCode::SUCCESS;
 }
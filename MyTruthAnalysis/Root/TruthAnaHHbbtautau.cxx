@@ -20,6 +20,7 @@
 // My headers
 #include "MyTruthAnalysis/TruthAnaHHbbtautau.h"
 #include "MyTruthAnalysis/HelperFunctions.h"
+#include "MyTruthAnalysis/ObjectSelection.h"
 
 // std
 #include <map>
@@ -37,21 +38,108 @@ TruthAnaHHbbtautau::TruthAnaHHbbtautau(const std::string &name,
                                        ISvcLocator *pSvcLocator)
     : TruthAnaBase(name, pSvcLocator)
 {
+  declareProperty("HiggsContainer", m_sHiggsContainer,
+                  "Slimmed truth boson container the Higgs decays are taken from, empty (default) to use the full record");
+  declareProperty("HardProcessScanLimit", m_nHardProcessScanLimit,
+                  "Number of leading truth particles searched for the Higgs decays, 0 (default) for the whole record; "
+                  "only safe for generators that write the decaying Higgs before the shower");
+  declareProperty("TauPtMin", m_fTauPtMin, "Minimum visible pT in GeV of both taus");
+  declareProperty("TauEtaMax", m_fTauEtaMax, "Maximum |eta| of both taus");
+  declareProperty("BPtMin", m_fBPtMin, "Minimum pT in GeV of both b quarks");
+  declareProperty("BEtaMax", m_fBEtaMax, "Maximum |eta| of both b quarks");
+  declareProperty("MTauTauMin", m_fMTauTauMin, "Minimum di-tau mass in GeV");
+  declareProperty("BTauOverlapDR", m_fBTauOverlapDR, "Minimum delta R between the b quarks and the taus");
+  declareProperty("STTTauPtMin", m_fSTTTauPtMin, "Single tau trigger: minimum visible pT in GeV of the leading tau");
+  declareProperty("STTBPtMin", m_fSTTBPtMin, "Single tau trigger: minimum pT in GeV of the leading b quark");
+  declareProperty("DTTTau0PtMin", m_fDTTTau0PtMin, "Di-tau trigger: minimum visible pT in GeV of the leading tau");
+  declareProperty("DTTTau1PtMin", m_fDTTTau1PtMin, "Di-tau trigger: minimum visible pT in GeV of the subleading tau");
+  declareProperty("DTTBPtMin", m_fDTTBPtMin, "Di-tau trigger: minimum pT in GeV of the leading b quark");
+  declareProperty("SamplingFraction", m_fSamplingFraction,
+                  "Fraction of events processed, selected by a hash of the event number");
+  declareProperty("SamplingSeed", m_nSamplingSeed,
+                  "Seed of the event number hash, different seeds give independent samples");
+  declareProperty("EarlyStopPrecision", m_fEarlyStopPrecision,
+                  "Stop once the EarlyStopCuts have this relative statistical error, 0 to disable");
+  declareProperty("EarlyStopCuts", m_vEarlyStopCuts,
+                  "Cutflow entries checked for EarlyStopPrecision");
+  declareProperty("EarlyStopMinEvents", m_nEarlyStopMinEvents,
+                  "Minimum number of events entering the selection before stopping early");
+  declareProperty("BjetPairing", m_sBjetPairing,
+                  "Choice of the resolved b-jet pair, Truth (matched to the b partons) or Mass");
+  declareProperty("BjetPairingMaxDR", m_fBjetPairingMaxDR,
+                  "Maximum delta R between a jet and its b parton in the Truth pairing");
+  declareProperty("BjetPairingMass", m_fBjetPairingMass,
+                  "Di-jet mass hypothesis in GeV of the Mass pairing");
 }
 
 StatusCode TruthAnaHHbbtautau::initialize()
 {
   ANA_MSG_INFO("Initializing ...");
+  ANA_CHECK(TruthAnaBase::initialize());
+  if (m_fSamplingFraction <= 0 || m_fSamplingFraction > 1)
+  {
+    ANA_MSG_ERROR("SamplingFraction must be in (0, 1], got " << m_fSamplingFraction);
+    return StatusCode::FAILURE;
+  }
+  if (m_sBjetPairing != "Truth" && m_sBjetPairing != "Mass")
+  {
+    ANA_MSG_ERROR("BjetPairing must be Truth or Mass, got " << m_sBjetPairing);
+    return StatusCode::FAILURE;
+  }
+  m_bPairByMass = m_sBjetPairing == "Mass";
   ANA_CHECK( book( TTree("MyTree", "truth analysis tree") ) );
   m_cTree = tree("MyTree");
   m_cTree->SetMaxTreeSize(500'000'000);
   initBranches();
+  setCuts({"Initial", "HH->bbtautau pre-classification", "Number of truth jets", "Empty cut for testing",
+           "OS Charge", "Tau Preselection", "B-jet preselection", "b-tau overlap removal",
+           "Trigger selection (TO CHECK)", "Di-tau mass selection"});
+  ANA_CHECK(compileCutExpressions());
+  if (m_fEarlyStopPrecision > 0)
+  {
+    if (m_vEarlyStopCuts.empty())
+    {
+      ANA_MSG_ERROR("EarlyStopPrecision needs at least one EarlyStopCuts entry");
+      return StatusCode::FAILURE;
+    }
+    // an unknown name would never reach the precision, and the early stop would silently not happen
+    for (const std::string &sCut : m_vEarlyStopCuts)
+    {
+      if (!hasCut(sCut))
+      {
+        ANA_MSG_ERROR("EarlyStopCuts entry \"" << sCut << "\" is not a cut of the analysis nor a cut expression");
+        return StatusCode::FAILURE;
+      }
+    }
+  }
+  setTraceConditions({"HiggsFromSlimmed", "HiggsFallback", "OSTaus", "OSBs", "GoodTau0", "GoodTau1",
+                      "GoodB0", "GoodB1", "NoOverlap", "STT", "DTT", "MTauTau"});
 
   return StatusCode::SUCCESS;
 }
 
 StatusCode TruthAnaHHbbtautau::execute()
 {
+  ANA_CHECK(TruthAnaBase::execute());
+  // in replay mode only the entries of the event list are read
+  if (!inEventList())
+    return StatusCode::SUCCESS;
+  // the requested precision is reached, the rest of the input is skipped without reading it
+  if (m_bEarlyStopped)
+    return StatusCode::SUCCESS;
+  // checked every 100 events that entered the selection, skipped events do not count
+  if (m_fEarlyStopPrecision > 0 && m_nInitialEvents >= m_nEarlyStopMinEvents &&
+      m_nInitialEvents >= m_nPrecisionCheckedAt + 100)
+  {
+    m_nPrecisionCheckedAt = m_nInitialEvents;
+    if (reachedPrecision())
+    {
+      ANA_MSG_INFO("Reached relative precision " << m_fEarlyStopPrecision << " after "
+                   << m_nInitialEvents << " selected events, skipping the remaining events");
+      m_bEarlyStopped = true;
+      return StatusCode::SUCCESS;
+    }
+  }
   resetBranches();
 
   // retrieve the eventInfo object from the event store
@@ -74,6 +162,54 @@ StatusCode TruthAnaHHbbtautau::execute()
     return StatusCode::SUCCESS;
   }
 
+  // deterministic prescale, the same events are kept in every run
+  if (m_fSamplingFraction < 1 && !isInSample(eventInfo->eventNumber(), m_nSamplingSeed, m_fSamplingFraction))
+    return StatusCode::SUCCESS;
+
+  // event info
+  m_nRunNumber = eventInfo->runNumber();
+  m_nEventNumber = eventInfo->eventNumber();
+  traceEvent(m_nRunNumber, m_nEventNumber);
+
+  // event weights
+  const vector<float> &weights = truthEvent->weights();
+  // not the product
+  // float mc_weights = std::accumulate(weights.begin(), weights.end(), 1, std::multiplies<float>());
+  m_fMCWeight = weights[0] / m_fSamplingFraction;
+  APPLYCUT(true, "Initial");
+  ++m_nInitialEvents;
+
+  // cheap pre-classification on the hard process, before anything else is read,
+  // so that events without the signal decays (e.g. backgrounds) are dropped right away
+  const xAOD::TruthParticle *higgsTauTau = nullptr;
+  const xAOD::TruthParticle *higgsBB = nullptr;
+  bool isHHbbtautau = false;
+
+  // the slimmed boson container is much smaller than the full record, use it if possible
+  const bool hasHiggsContainer = !m_sHiggsContainer.empty() && evtStore()->contains<xAOD::TruthParticleContainer>(m_sHiggsContainer);
+  bool needsFullRecord = !hasHiggsContainer;
+  if (hasHiggsContainer)
+  {
+    const xAOD::TruthParticleContainer *truthBosons = nullptr;
+    ANA_CHECK(evtStore()->retrieve(truthBosons, m_sHiggsContainer));
+    // the tau decays must be complete there too, the visible taus need the neutrinos
+    const bool hasDecays = findHiggsDecays(truthBosons, higgsTauTau, higgsBB);
+    isHHbbtautau = hasDecays &&
+                   hasChild(getFinal(higgsTauTau->child(0)), 16) && hasChild(getFinal(higgsTauTau->child(1)), 16);
+    traceCondition(TRACE_HIGGS_SLIMMED, isHHbbtautau);
+    // without any Higgs candidate (e.g. backgrounds) the event is rejected right here,
+    // the full record is only needed if the slimming cut a Higgs decay chain short
+    needsFullRecord = !isHHbbtautau && (hasDecays || hasIncompleteHiggsDecay(truthBosons));
+  }
+  if (needsFullRecord)
+  {
+    APPLYCOUNT(!m_sHiggsContainer.empty(), "Higgs search fell back to full truth record");
+    traceCondition(TRACE_HIGGS_FALLBACK, true);
+    isHHbbtautau = findHiggsDecays(truthEvent, m_nHardProcessScanLimit, higgsTauTau, higgsBB);
+  }
+  APPLYCOUNT(!isHHbbtautau, "No H->tautau + H->bb");
+  APPLYCUT(isHHbbtautau, "HH->bbtautau pre-classification");
+
   // retrieve truth taus container
   const xAOD::TruthParticleContainer *truthTaus = nullptr;
   ANA_CHECK(evtStore()->retrieve(truthTaus, "TruthTaus"));
@@ -89,58 +225,19 @@ StatusCode TruthAnaHHbbtautau::execute()
   ANA_CHECK(evtStore()->retrieve(fatjets, "AntiKt10TruthTrimmedPtFrac5SmallR20Jets"));
   // should contain at least one large radius jets!
   ANA_MSG_DEBUG("Jet container size: " << fatjets->size());
-  
-  // event info
-  m_nRunNumber = eventInfo->runNumber();
-  m_nEventNumber = eventInfo->eventNumber();
 
-  // event weights
-  const vector<float> weights = truthEvent->weights();
-  // not the product
-  // float mc_weights = std::accumulate(weights.begin(), weights.end(), 1, std::multiplies<float>());
-  m_fMCWeight = weights[0];
-  APPLYCUT(true, "Initial");
+  // comes after the pre-classification, so that the jet containers are not read for rejected
+  // events; cutflows from before this ordering list the two rows the other way around
   APPLYCUT(jets->size() > 2 || fatjets->size() > 1, "Number of truth jets")
   
   // objects
-  std::map<std::string, const xAOD::TruthParticle *> higgsMap{};
-  vector<const xAOD::TruthParticle *> truthTauVec{};
-  vector<const xAOD::Jet *> truthJetVec{};
-  vector<const xAOD::Jet *> truthFatJetVec{};
-
-  bool found_htautau = false;
-  bool found_hbb = false;
-
-  for (std::size_t i = 0; i < truthEvent->nTruthParticles(); i++)
-  {
-    const xAOD::TruthParticle *particle = truthEvent->truthParticle(i);
-
-    // Some debug output
-    if (i == 0)
-    {
-      ANA_MSG_DEBUG("Particle info: ");
-      ANA_MSG_DEBUG(" - Barcode: " << particle->barcode());
-      ANA_MSG_DEBUG(" - PDG ID : " << particle->pdgId());
-      ANA_MSG_DEBUG(" - Pt     : " << particle->pt());
-    }
-
-    // fetch Higgs
-    vector<unsigned> trash_tautau_idx;
-    if (!found_htautau && particle->pdgId() == 25 && particle->nChildren() == 2 && hasChild(particle, 15, trash_tautau_idx))
-    {
-      found_htautau = true;
-      higgsMap.insert({"Htautau", particle});
-    }
-
-    vector<unsigned> trash_bb_idx;
-    if (!found_hbb && particle->pdgId() == 25 && particle->nChildren() == 2 && hasChild(particle, 5, trash_tautau_idx))
-    {
-      found_hbb = true;
-      higgsMap.insert({"Hbb", particle});
-    }
-
-    if (found_hbb && found_htautau) break;
-  }
+  // temporaries live in the event arena, so that the steady-state loop does not allocate
+  ArenaVector<const xAOD::TruthParticle *> truthTauVec{arena<const xAOD::TruthParticle *>()};
+  ArenaVector<const xAOD::Jet *> truthJetVec{arena<const xAOD::Jet *>()};
+  ArenaVector<const xAOD::Jet *> truthFatJetVec{arena<const xAOD::Jet *>()};
+  truthTauVec.reserve(truthTaus->size());
+  truthJetVec.reserve(jets->size());
+  truthFatJetVec.reserve(fatjets->size());
 
   // fetch truth taus
   for (std::size_t i = 0; i < truthTaus->size(); i++)
@@ -151,17 +248,19 @@ StatusCode TruthAnaHHbbtautau::execute()
     }
   }
   ANA_MSG_DEBUG("Truth taus vector size: " << truthTauVec.size());
+  m_sDecision.nTaus = DecisionRecord::count(truthTauVec.size());
+  m_sDecision.nJets = DecisionRecord::count(jets->size());
+  m_sDecision.nFatJets = DecisionRecord::count(fatjets->size());
 
   // particles
-  const xAOD::TruthParticle *tau0 = getFinal(higgsMap["Htautau"]->child(0));
-  const xAOD::TruthParticle *tau1 = getFinal(higgsMap["Htautau"]->child(1));
-  const xAOD::TruthParticle* b0   = getFinal(higgsMap["Hbb"]->child(0));
-  const xAOD::TruthParticle* b1   = getFinal(higgsMap["Hbb"]->child(1));
-  // const xAOD::TruthParticle *b0 = higgsMap["Hbb"]->child(0);
-  // const xAOD::TruthParticle *b1 = higgsMap["Hbb"]->child(1);
+  const xAOD::TruthParticle *tau0 = getFinal(higgsTauTau->child(0));
+  const xAOD::TruthParticle *tau1 = getFinal(higgsTauTau->child(1));
+  const xAOD::TruthParticle* b0   = getFinal(higgsBB->child(0));
+  const xAOD::TruthParticle* b1   = getFinal(higgsBB->child(1));
+  // const xAOD::TruthParticle *b0 = higgsBB->child(0);
+  // const xAOD::TruthParticle *b1 = higgsBB->child(1);
 
   // fetch small R b-jets
-  vector<int> btag_idx{};
   for (std::size_t i = 0; i < jets->size(); i++)
   {
     ANA_MSG_DEBUG("Jet truth flavour info: ");
@@ -171,18 +270,17 @@ StatusCode TruthAnaHHbbtautau::execute()
     if (isBJet(jets->at(i)))
     { // isBJet -> TruthFlavor == 5
       truthJetVec.push_back(jets->at(i));
-      btag_idx.push_back(i);
     }
   }
 
   // fetch large R di-b-jet
-  vector<int> dibtag_idx{};
+  m_cDiBTagMask.reset(fatjets->size());
   for (std::size_t i = 0; i < fatjets->size(); i++)
   {
     if (isDiBJet(fatjets->at(i), b0, b1))
     {
       truthFatJetVec.push_back(fatjets->at(i));
-      dibtag_idx.push_back(i);
+      m_cDiBTagMask.insert(i);
     }
   }
 
@@ -196,18 +294,25 @@ StatusCode TruthAnaHHbbtautau::execute()
   
   // to be saved in the ntuple
   m_nChannel = static_cast<unsigned long long>(m_eChannel);
-
-  // if less than two truth b-tag jet, push the leading jet of the remaining jets to the vec
-  if (truthJetVec.size() < 2)
+  m_sDecision.channel = static_cast<std::uint8_t>(m_eChannel);
+  m_sDecision.nBJets = DecisionRecord::count(truthJetVec.size());
+
+  // taus for the jet overlap removal below
+  m_cTauGrid.clear();
+  m_cTauGrid.add(tau0);
+  m_cTauGrid.add(tau1);
+  m_cTauGrid.build();
+
+  // the resolved b-jet pair is chosen among all jets away from the taus, not only the b-labelled ones
+  ArenaVector<const xAOD::Jet *> pairingJetVec{arena<const xAOD::Jet *>()};
+  pairingJetVec.reserve(jets->size());
+  m_cJetPairing.clear();
+  for (const xAOD::Jet *jet : *jets)
   {
-    for (std::size_t i = 0; i < jets->size(); i++)
+    if (!m_cTauGrid.anyWithin(jet, 0.4))
     {
-      if (!contains(btag_idx, i) && (jets->at(i)->p4().DeltaR(tau0->p4())) > 0.4 && (jets->at(i)->p4().DeltaR(tau1->p4())) > 0.4)
-      {
-        truthJetVec.push_back(jets->at(i));
-      }
-      if (truthJetVec.size() == 2)
-        break;
+      pairingJetVec.push_back(jet);
+      m_cJetPairing.add(jet);
     }
   }
 
@@ -216,7 +321,7 @@ StatusCode TruthAnaHHbbtautau::execute()
   {
     for (std::size_t i = 0; i < fatjets->size(); i++)
     {
-      if (!contains(dibtag_idx, i) && (fatjets->at(i)->p4().DeltaR(tau0->p4())) > 1.0 && (fatjets->at(i)->p4().DeltaR(tau1->p4())) > 1.0)
+      if (!m_cDiBTagMask.contains(i) && !m_cTauGrid.anyWithin(fatjets->at(i), 1.0))
       {
         truthFatJetVec.push_back(fatjets->at(i));
       }
@@ -230,27 +335,46 @@ StatusCode TruthAnaHHbbtautau::execute()
   TLorentzVector tauvis0_p4 = tauVisP4(tau0), tauvis1_p4 = tauVisP4(tau1);
   TLorentzVector b0_p4 = b0->p4(), b1_p4 = b1->p4();
 
-  ANA_MSG_DEBUG(printVec(btag_idx, "btag_idx"));
   ANA_MSG_DEBUG("Jet vector size: " << truthJetVec.size());
   
-  ANA_MSG_DEBUG("Htautau : " << higgsMap["Htautau"]->child(0)->pdgId() << ", " << higgsMap["Htautau"]->child(1)->pdgId());
-  ANA_MSG_DEBUG("Hbb     : " << higgsMap["Hbb"]->child(0)->pdgId() << ", " << higgsMap["Hbb"]->child(1)->pdgId());
+  ANA_MSG_DEBUG("Htautau : " << higgsTauTau->child(0)->pdgId() << ", " << higgsTauTau->child(1)->pdgId());
+  ANA_MSG_DEBUG("Hbb     : " << higgsBB->child(0)->pdgId() << ", " << higgsBB->child(1)->pdgId());
 
-  APPLYCUT(isGoodEvent(), "Empty cut for testing");
-  APPLYCUT(isOS(tau0, tau1) && isOS(b0, b1), "OS Charge");
-  APPLYCUT(isGoodTau(tau0, 20., 2.5) && isGoodTau(tau1, 20., 2.5), "Tau Preselection"); 
-  APPLYCUT(isGoodB(b0, 20., 2.4) && isGoodB(b1, 20., 2.4), "B-jet preselection");
-  APPLYCUT(isNotOverlap(b0, b1, tau0, tau1, 0.2), "b-tau overlap removal");
+  // intermediate conditions, also kept in the decision trace
+  const bool isOSTaus = isOS(tau0, tau1), isOSBs = isOS(b0, b1);
+  const bool isGoodTau0 = isGoodTau(tau0, m_fTauPtMin, m_fTauEtaMax), isGoodTau1 = isGoodTau(tau1, m_fTauPtMin, m_fTauEtaMax);
+  const bool isGoodB0 = isGoodB(b0, m_fBPtMin, m_fBEtaMax), isGoodB1 = isGoodB(b1, m_fBPtMin, m_fBEtaMax);
+  const bool isNotOverlapBTau = isNotOverlap(b0, b1, tau0, tau1, m_fBTauOverlapDR);
 
   // mimic single tau trigger selection
-  bool STT = isGoodTau(tau0, 100., 2.5) && isGoodB(b0, 45., 2.4);
+  bool STT = isGoodTau(tau0, m_fSTTTauPtMin, 2.5) && isGoodB(b0, m_fSTTBPtMin, 2.4);
 
   // mimic di-tau trigger selection
-  bool DTT = isGoodTau(tau0, 40., 2.5) && isGoodTau(tau1, 30., 2.5) && isGoodB(b0, 80., 2.4);
+  bool DTT = isGoodTau(tau0, m_fDTTTau0PtMin, 2.5) && isGoodTau(tau1, m_fDTTTau1PtMin, 2.5) && isGoodB(b0, m_fDTTBPtMin, 2.4);
+
+  const bool isMTauTau = (tau0_p4 + tau1_p4).M() > m_fMTauTauMin * GeV;
+
+  traceCondition(TRACE_OS_TAUS, isOSTaus);
+  traceCondition(TRACE_OS_BS, isOSBs);
+  traceCondition(TRACE_GOOD_TAU0, isGoodTau0);
+  traceCondition(TRACE_GOOD_TAU1, isGoodTau1);
+  traceCondition(TRACE_GOOD_B0, isGoodB0);
+  traceCondition(TRACE_GOOD_B1, isGoodB1);
+  traceCondition(TRACE_NO_OVERLAP, isNotOverlapBTau);
+  traceCondition(TRACE_STT, STT);
+  traceCondition(TRACE_DTT, DTT);
+  traceCondition(TRACE_MTAUTAU, isMTauTau);
+
+  APPLYCUT(isGoodEvent(), "Empty cut for testing");
+  APPLYCUT(isOSTaus && isOSBs, "OS Charge");
+  APPLYCUT(isGoodTau0 && isGoodTau1, "Tau Preselection"); 
+  APPLYCUT(isGoodB0 && isGoodB1, "B-jet preselection");
+  APPLYCUT(isNotOverlapBTau, "b-tau overlap removal");
 
   // event must pass single tau trigger or di-tau trigger
   APPLYCUT(STT || DTT, "Trigger selection (TO CHECK)");
-  APPLYCUT((tau0_p4 + tau1_p4).M() > 60 * GeV, "Di-tau mass selection");
+  APPLYCUT(isMTauTau, "Di-tau mass selection");
+  recordEvent(m_nRunNumber, m_nEventNumber);
 
   // 4-momenta
   m_fTau0_pt = tau0_p4.Pt() / GeV;
@@ -290,9 +414,8 @@ StatusCode TruthAnaHHbbtautau::execute()
   m_fMBB = (b0_p4 + b1_p4).M() / GeV;
   m_fMHH = (tau0_p4 + tau1_p4 + b0_p4 + b1_p4).M() / GeV;
 
-  // n jets after adding additional non b-tagged jet
-  // TODO many veto those events
-  m_nJets = truthJetVec.size();
+  // n jets the b-jet pair is chosen from
+  m_nJets = pairingJetVec.size();
   m_nFatJets = truthFatJetVec.size();
 
   APPLYCOUNT(true, "All");
@@ -300,12 +423,12 @@ StatusCode TruthAnaHHbbtautau::execute()
   APPLYCOUNT(m_eChannel == CHAN::RESOLVED, "Resolved");
   APPLYCOUNT(m_eChannel == CHAN::BOOSTED, "Boosted");
 
-  if (m_nJets >= 2) // only make sense for Resolved channel
+  const JetPairing::Pair bjetPair = m_bPairByMass ? m_cJetPairing.matchMass(m_fBjetPairingMass * GeV)
+                                                  : m_cJetPairing.matchPartons(b0, b1, m_fBjetPairingMaxDR);
+  if (bjetPair.found()) // only make sense for Resolved channel
   {
-    std::sort(truthJetVec.begin(), truthJetVec.end(), 
-      [](const xAOD::Jet *a, const xAOD::Jet *b) { return a->pt() > b->pt(); });
-    const xAOD::Jet *bjet0 = truthJetVec[0];
-    const xAOD::Jet *bjet1 = truthJetVec[1];
+    const xAOD::Jet *bjet0 = pairingJetVec[bjetPair.first];
+    const xAOD::Jet *bjet1 = pairingJetVec[bjetPair.second];
 
     TLorentzVector bjet0_p4, bjet1_p4;
     bjet0_p4 = bjet0->p4();
@@ -319,13 +442,14 @@ StatusCode TruthAnaHHbbtautau::execute()
     m_fDeltaR_BjetBjet = bjet0_p4.DeltaR(bjet1_p4);
     m_fDeltaR_BjetBjet_TauVisTauVis = (bjet0_p4 + bjet1_p4).DeltaR(tauvis0_p4 + tauvis1_p4);
     m_fMBjetBjet = (bjet0_p4 + bjet1_p4).M() / GeV;
+    // delta R sum for the Truth pairing, mass distance in GeV for the Mass pairing
+    m_fBjetPairScore = m_bPairByMass ? bjetPair.score / GeV : bjetPair.score;
   }
 
   if (m_nFatJets >= 1) // only make sense for Boosted channel
   {
-    std::sort(truthFatJetVec.begin(), truthFatJetVec.end(), 
-      [](const xAOD::Jet *a, const xAOD::Jet *b) { return a->pt() > b->pt(); });
-    const xAOD::Jet *dibjet = truthJetVec[0];
+    topKByPt(truthFatJetVec, 1);
+    const xAOD::Jet *dibjet = truthFatJetVec[0];
 
     TLorentzVector dibjet_p4;
     dibjet_p4 = dibjet->p4();
@@ -339,6 +463,11 @@ StatusCode TruthAnaHHbbtautau::execute()
   ANA_MSG_DEBUG("Found Higgs -> tautau, delta R(tau, tau) : " << m_fDeltaR_TauTau);
   ANA_MSG_DEBUG("Found Higgs -> bb,     delta R(b, b)     : " << m_fDeltaR_BB);
 
+  // runtime-configured cuts over the branches above
+  if (!applyCutExpressions(m_fMCWeight))
+    return StatusCode::SUCCESS;
+
+  m_sDecision.flags |= DecisionRecord::kAccepted;
   m_cTree->Fill();
 
   return StatusCode::SUCCESS;
@@ -347,64 +476,85 @@ StatusCode TruthAnaHHbbtautau::execute()
 StatusCode TruthAnaHHbbtautau::finalize()
 {
   ANA_MSG_INFO("Finalizing ...");
+  if (m_fSamplingFraction < 1)
+  {
+    ANA_MSG_INFO("Sampled a fraction " << m_fSamplingFraction << " of the events (seed " << m_nSamplingSeed
+                 << "), weights are scaled by " << 1. / m_fSamplingFraction);
+  }
+  for (const std::string &sCut : m_vEarlyStopCuts)
+  {
+    ANA_MSG_INFO("Relative statistical error of \"" << sCut << "\": " << m_cCutflow->relativeError(sCut));
+  }
   m_cCutflow->print();
+  ANA_CHECK(TruthAnaBase::finalize());
   return StatusCode::SUCCESS;
 }
 
+bool TruthAnaHHbbtautau::reachedPrecision() const
+{
+  for (const std::string &sCut : m_vEarlyStopCuts)
+  {
+    if (m_cCutflow->relativeError(sCut) > m_fEarlyStopPrecision)
+      return false;
+  }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 // Function for trees
 // ----------------------------------------------------------------------------
 
 void TruthAnaHHbbtautau::initBranches()
 {
-  m_cTree->Branch("EventNumber", &m_nEventNumber);
-  m_cTree->Branch("RunNumber", &m_nRunNumber);
-  m_cTree->Branch("NJets", &m_nJets);
-  m_cTree->Branch("NFatJets", &m_nFatJets);
-  m_cTree->Branch("Tau0_pt", &m_fTau0_pt);
-  m_cTree->Branch("Tau1_pt", &m_fTau1_pt);
-  m_cTree->Branch("Tau0_phi", &m_fTau0_phi);
-  m_cTree->Branch("Tau1_phi", &m_fTau1_phi);
-  m_cTree->Branch("Tau0_eta", &m_fTau0_eta);
-  m_cTree->Branch("Tau1_eta", &m_fTau1_eta);
-  m_cTree->Branch("TauVis0_pt", &m_fTauVis0_pt);
-  m_cTree->Branch("TauVis1_pt", &m_fTauVis1_pt);
-  m_cTree->Branch("TauVis0_phi", &m_fTauVis0_phi);
-  m_cTree->Branch("TauVis1_phi", &m_fTauVis1_phi);
-  m_cTree->Branch("TauVis0_eta", &m_fTauVis0_eta);
-  m_cTree->Branch("TauVis1_eta", &m_fTauVis1_eta);
-  m_cTree->Branch("B0_pt", &m_fB0_pt);
-  m_cTree->Branch("B1_pt", &m_fB1_pt);
-  m_cTree->Branch("B0_phi", &m_fB0_phi);
-  m_cTree->Branch("B1_phi", &m_fB1_phi);
-  m_cTree->Branch("B0_eta", &m_fB0_eta);
-  m_cTree->Branch("B1_eta", &m_fB1_eta);
-  m_cTree->Branch("Bjet0_pt", &m_fBjet0_pt);
-  m_cTree->Branch("Bjet1_pt", &m_fBjet1_pt);
-  m_cTree->Branch("Bjet0_phi", &m_fBjet0_phi);
-  m_cTree->Branch("Bjet1_phi", &m_fBjet1_phi);
-  m_cTree->Branch("Bjet0_eta", &m_fBjet0_eta);
-  m_cTree->Branch("Bjet1_eta", &m_fBjet1_eta);
-  m_cTree->Branch("DiBjet_pt", &m_fDiBjet_pt);
-  m_cTree->Branch("DiBjet_m", &m_fDiBjet_m);
-  m_cTree->Branch("DiBjet_phi", &m_fDiBjet_phi);
-  m_cTree->Branch("DiBjet_eta", &m_fDiBjet_eta);
-  m_cTree->Branch("DeltaR_BB", &m_fDeltaR_BB);
-  m_cTree->Branch("DeltaR_BjetBjet", &m_fDeltaR_BjetBjet);
-  m_cTree->Branch("DeltaR_TauTau", &m_fDeltaR_TauTau);
-  m_cTree->Branch("DeltaR_TauVisTauVis", &m_fDeltaR_TauVisTauVis);
-  m_cTree->Branch("DeltaR_BB_TauTau", &m_fDeltaR_BB_TauTau);
-  m_cTree->Branch("DeltaR_BjetBjet_TauVisTauVis", &m_fDeltaR_BjetBjet_TauVisTauVis);
-  m_cTree->Branch("DeltaR_DiBjet_TauVisTauVis", &m_fDeltaR_DiBjet_TauVisTauVis);
-  m_cTree->Branch("MBB", &m_fMBB);
-  m_cTree->Branch("MTauTau", &m_fMTauTau);
-  m_cTree->Branch("MBjetBjet", &m_fMBjetBjet);
-  m_cTree->Branch("MTauVisTauVis", &m_fMTauVisTauVis);
-  m_cTree->Branch("MHH", &m_fMHH);
-  m_cTree->Branch("PtBB", &m_fPtBB);
-  m_cTree->Branch("PtTauTau", &m_fPtTauTau);
-  m_cTree->Branch("MCWeight", &m_fMCWeight);
-  m_cTree->Branch("Channel", &m_nChannel);
+  bookBranch(m_cTree, "EventNumber", &m_nEventNumber);
+  bookBranch(m_cTree, "RunNumber", &m_nRunNumber);
+  bookBranch(m_cTree, "NJets", &m_nJets);
+  bookBranch(m_cTree, "NFatJets", &m_nFatJets);
+  bookBranch(m_cTree, "Tau0_pt", &m_fTau0_pt);
+  bookBranch(m_cTree, "Tau1_pt", &m_fTau1_pt);
+  bookBranch(m_cTree, "Tau0_phi", &m_fTau0_phi);
+  bookBranch(m_cTree, "Tau1_phi", &m_fTau1_phi);
+  bookBranch(m_cTree, "Tau0_eta", &m_fTau0_eta);
+  bookBranch(m_cTree, "Tau1_eta", &m_fTau1_eta);
+  bookBranch(m_cTree, "TauVis0_pt", &m_fTauVis0_pt);
+  bookBranch(m_cTree, "TauVis1_pt", &m_fTauVis1_pt);
+  bookBranch(m_cTree, "TauVis0_phi", &m_fTauVis0_phi);
+  bookBranch(m_cTree, "TauVis1_phi", &m_fTauVis1_phi);
+  bookBranch(m_cTree, "TauVis0_eta", &m_fTauVis0_eta);
+  bookBranch(m_cTree, "TauVis1_eta", &m_fTauVis1_eta);
+  bookBranch(m_cTree, "B0_pt", &m_fB0_pt);
+  bookBranch(m_cTree, "B1_pt", &m_fB1_pt);
+  bookBranch(m_cTree, "B0_phi", &m_fB0_phi);
+  bookBranch(m_cTree, "B1_phi", &m_fB1_phi);
+  bookBranch(m_cTree, "B0_eta", &m_fB0_eta);
+  bookBranch(m_cTree, "B1_eta", &m_fB1_eta);
+  bookBranch(m_cTree, "Bjet0_pt", &m_fBjet0_pt);
+  bookBranch(m_cTree, "Bjet1_pt", &m_fBjet1_pt);
+  bookBranch(m_cTree, "Bjet0_phi", &m_fBjet0_phi);
+  bookBranch(m_cTree, "Bjet1_phi", &m_fBjet1_phi);
+  bookBranch(m_cTree, "Bjet0_eta", &m_fBjet0_eta);
+  bookBranch(m_cTree, "Bjet1_eta", &m_fBjet1_eta);
+  bookBranch(m_cTree, "BjetPairScore", &m_fBjetPairScore);
+  bookBranch(m_cTree, "DiBjet_pt", &m_fDiBjet_pt);
+  bookBranch(m_cTree, "DiBjet_m", &m_fDiBjet_m);
+  bookBranch(m_cTree, "DiBjet_phi", &m_fDiBjet_phi);
+  bookBranch(m_cTree, "DiBjet_eta", &m_fDiBjet_eta);
+  bookBranch(m_cTree, "DeltaR_BB", &m_fDeltaR_BB);
+  bookBranch(m_cTree, "DeltaR_BjetBjet", &m_fDeltaR_BjetBjet);
+  bookBranch(m_cTree, "DeltaR_TauTau", &m_fDeltaR_TauTau);
+  bookBranch(m_cTree, "DeltaR_TauVisTauVis", &m_fDeltaR_TauVisTauVis);
+  bookBranch(m_cTree, "DeltaR_BB_TauTau", &m_fDeltaR_BB_TauTau);
+  bookBranch(m_cTree, "DeltaR_BjetBjet_TauVisTauVis", &m_fDeltaR_BjetBjet_TauVisTauVis);
+  bookBranch(m_cTree, "DeltaR_DiBjet_TauVisTauVis", &m_fDeltaR_DiBjet_TauVisTauVis);
+  bookBranch(m_cTree, "MBB", &m_fMBB);
+  bookBranch(m_cTree, "MTauTau", &m_fMTauTau);
+  bookBranch(m_cTree, "MBjetBjet", &m_fMBjetBjet);
+  bookBranch(m_cTree, "MTauVisTauVis", &m_fMTauVisTauVis);
+  bookBranch(m_cTree, "MHH", &m_fMHH);
+  bookBranch(m_cTree, "PtBB", &m_fPtBB);
+  bookBranch(m_cTree, "PtTauTau", &m_fPtTauTau);
+  bookBranch(m_cTree, "MCWeight", &m_fMCWeight);
+  bookBranch(m_cTree, "Channel", &m_nChannel);
 }
 
 void TruthAnaHHbbtautau::resetBranches()
@@ -437,6 +587,7 @@ void TruthAnaHHbbtautau::resetBranches()
   m_fBjet1_phi = 0; // DONE
   m_fBjet0_eta = 0; // DONE
   m_fBjet1_eta = 0; // DONE
+  m_fBjetPairScore = -1; // no pair
   m_fDiBjet_pt = 0; // DONE
   m_fDiBjet_m = 0; // DONE
   m_fDiBjet_phi = 0; // DONE
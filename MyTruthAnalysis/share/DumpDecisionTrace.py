@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+
+# Print the binary decision trace written by TruthAnaBase (DecisionTraceFile)
+# as readable text. Does not need ROOT.
+import optparse
+import struct
+import sys
+
+parser = optparse.OptionParser( usage = '%prog [options] trace.bin' )
+parser.add_option( '-e', '--event', dest = 'events',
+                   action = 'append', type = 'int', default = [],
+                   help = 'Only print this event number, can be repeated' )
+parser.add_option( '-f', '--failed-only', dest = 'failed_only',
+                   action = 'store_true', default = False,
+                   help = 'Only print the events that were not accepted' )
+parser.add_option( '-s', '--summary', dest = 'summary',
+                   action = 'store_true', default = False,
+                   help = 'Only print the number of events failing each cut' )
+( options, args ) = parser.parse_args()
+if len( args ) != 1:
+    parser.error( 'expected one trace file' )
+
+RECORD = struct.Struct( '<QQIHBBBBBB4x' )
+CHANNELS = [ 'UNKNOWN', 'RESOLVED', 'BOOSTED' ]
+TRACED, ACCEPTED = 1, 2
+
+def readNames( data, offset ):
+    n, = struct.unpack_from( '<I', data, offset )
+    offset += 4
+    names = []
+    for i in range( n ):
+        length, = struct.unpack_from( '<H', data, offset )
+        names.append( data[ offset + 2 : offset + 2 + length ].decode() )
+        offset += 2 + length
+    return names, offset
+
+with open( args[0], 'rb' ) as f:
+    data = f.read()
+
+magic, version, recordSize, reserved = struct.unpack_from( '<4sIII', data, 0 )
+if magic != b'TADT' or data[-4:] != b'TADE':
+    sys.exit( '%s is not a complete decision trace file' % args[0] )
+if version != 1 or recordSize != RECORD.size:
+    sys.exit( 'unsupported decision trace version %d, record size %d' % ( version, recordSize ) )
+
+trailer, = struct.unpack_from( '<Q', data, len( data ) - 12 )
+cuts, offset = readNames( data, trailer )
+conditions, offset = readNames( data, offset )
+dropped, = struct.unpack_from( '<Q', data, offset )
+
+nRecords = ( trailer - 16 ) // RECORD.size
+failures = {}
+for i in range( nRecords ):
+    ( run, event, bits, cutsPassed, flags, channel,
+      nTaus, nJets, nFatJets, nBJets ) = RECORD.unpack_from( data, 16 + i * RECORD.size )
+    accepted = bool( flags & ACCEPTED )
+    if accepted:
+        decision = 'accepted'
+    elif cutsPassed < len( cuts ):
+        decision = 'failed "%s"' % cuts[ cutsPassed ]
+    else:
+        decision = 'failed after "%s"' % ( cuts[-1] if cuts else '' )
+    failures[ decision ] = failures.get( decision, 0 ) + 1
+
+    if options.summary:
+        continue
+    if options.events and event not in options.events:
+        continue
+    if options.failed_only and accepted:
+        continue
+    names = [ conditions[b] if b < len( conditions ) else 'bit%d' % b
+              for b in range( 32 ) if bits >> b & 1 ]
+    print( 'run %d event %d: %s, channel %s, taus %d jets %d fatjets %d bjets %d, conditions [%s]' % (
+        run, event, decision, CHANNELS[ channel ] if channel < len( CHANNELS ) else channel,
+        nTaus, nJets, nFatJets, nBJets, ' '.join( names ) ) )
+
+print( '%d records, %d dropped by the writer' % ( nRecords, dropped ) )
+if options.summary:
+    for decision, n in sorted( failures.items(), key = lambda p: -p[1] ):
+        print( '  %8d %s' % ( n, decision ) )
@@ -18,37 +18,359 @@ parser.add_option( '-p', '--file-pattern', dest = 'file_pattern',
 parser.add_option( '-n', '--n-events', dest = 'n_events',
                    action = 'store', type = 'int',
                    default = -1, help = 'Number of events to run')
+parser.add_option( '--cache-size', dest = 'cache_size',
+                   action = 'store', type = 'int',
+                   default = 10 * 1024 * 1024,
+                   help = 'Size of the input TTreeCache in bytes, 0 to disable')
+parser.add_option( '--cache-learn-entries', dest = 'cache_learn_entries',
+                   action = 'store', type = 'int',
+                   default = 20, help = 'Number of entries the TTreeCache learns from')
+parser.add_option( '--access-mode', dest = 'access_mode',
+                   action = 'store', type = 'choice',
+                   choices = [ 'branch', 'class' ], default = 'branch',
+                   help = 'xAOD access mode, branch only reads the variables that are used')
+parser.add_option( '--auto-prune', dest = 'auto_prune',
+                   action = 'store_true', default = False,
+                   help = 'Run a short first pass to find the branches the algorithm reads and only cache those')
+parser.add_option( '--prune-events', dest = 'prune_events',
+                   action = 'store', type = 'int',
+                   default = 500, help = 'Number of events of the --auto-prune pass')
+parser.add_option( '--cache-branches', dest = 'cache_branches',
+                   action = 'store', type = 'string', default = '',
+                   help = 'File with the branches to cache, one per line (as written by --auto-prune)')
+parser.add_option( '--read-stats', dest = 'read_stats',
+                   action = 'store_true', default = False,
+                   help = 'Print the xAOD read statistics at the end of the job')
+parser.add_option( '-c', '--cut', dest = 'cuts',
+                   action = 'append', type = 'string', default = [],
+                   help = 'Extra cut "name: expression" over the output branches, can be repeated')
+parser.add_option( '--monitor-file', dest = 'monitor_file',
+                   action = 'store', type = 'string', default = '',
+                   help = 'JSON file with the live job status (rate, memory, ETA, cutflow)')
+parser.add_option( '--monitor-interval', dest = 'monitor_interval',
+                   action = 'store', type = 'float',
+                   default = 10., help = 'Seconds between two updates of the --monitor-file')
+parser.add_option( '--higgs-container', dest = 'higgs_container',
+                   action = 'store', type = 'string',
+                   default = '',
+                   help = 'Slimmed truth boson container to find the Higgs decays in (e.g. TruthBosonsWithDecayParticles), '
+                          'by default the full truth record is searched')
+parser.add_option( '--bjet-pairing', dest = 'bjet_pairing',
+                   action = 'store', type = 'choice', choices = [ 'Truth', 'Mass' ],
+                   default = 'Truth',
+                   help = 'Resolved b-jet pair: matched to the b partons (Truth) or closest to --bjet-pairing-mass (Mass)')
+parser.add_option( '--bjet-pairing-mass', dest = 'bjet_pairing_mass',
+                   action = 'store', type = 'float', default = 125.,
+                   help = 'Di-jet mass hypothesis in GeV of the Mass b-jet pairing')
+parser.add_option( '--bjet-pairing-max-dr', dest = 'bjet_pairing_max_dr',
+                   action = 'store', type = 'float', default = 0.4,
+                   help = 'Maximum delta R between a jet and its b parton in the Truth b-jet pairing')
+parser.add_option( '--metadata-cache', dest = 'metadata_cache',
+                   action = 'store', type = 'string', default = '',
+                   help = 'Input metadata cache file, default is one per input directory and pattern in ~/.cache/TruthAnalysis, "none" to scan the directory with SampleHandler')
+parser.add_option( '--workers', dest = 'workers',
+                   action = 'store', type = 'int',
+                   default = 1, help = 'Split the input files into this many samples with balanced numbers of entries, run one of them with --worker-index')
+parser.add_option( '--worker-index', dest = 'worker_index',
+                   action = 'store', type = 'int',
+                   default = -1, help = 'Only run the split with this index (0 ... workers-1)')
+parser.add_option( '--sampling-fraction', dest = 'sampling_fraction',
+                   action = 'store', type = 'float',
+                   default = 1., help = 'Process this fraction of the events, chosen by a hash of the event number')
+parser.add_option( '--sampling-seed', dest = 'sampling_seed',
+                   action = 'store', type = 'int',
+                   default = 0, help = 'Seed for --sampling-fraction')
+parser.add_option( '--target-precision', dest = 'target_precision',
+                   action = 'store', type = 'float', default = 0.,
+                   help = 'Stop once the --precision-cut entries reach this relative statistical error')
+parser.add_option( '--precision-cut', dest = 'precision_cuts',
+                   action = 'append', type = 'string', default = [],
+                   help = 'Cutflow entry checked for --target-precision, can be repeated (default: Di-tau mass selection)')
+parser.add_option( '--replay', dest = 'replay',
+                   action = 'store', type = 'string', default = '',
+                   help = 'Submission directory or output file of a previous run, only its selected events are processed, '
+                          'without TTreeCache and --n-events')
+parser.add_option( '--replay-max-ranges', dest = 'replay_max_ranges',
+                   action = 'store', type = 'int', default = 8,
+                   help = 'Entry ranges per input file a --replay is split into, each one runs as a sample')
+parser.add_option( '--trace-file', dest = 'trace_file',
+                   action = 'store', type = 'string', default = '',
+                   help = 'Binary per-event decision trace, print it with DumpDecisionTrace.py')
 ( options, args ) = parser.parse_args()
+if options.workers > 1 and not 0 <= options.worker_index < options.workers:
+    # the direct driver would run all splits one after the other in this process
+    parser.error( '--workers %d needs --worker-index in 0 ... %d, one process per split' % ( options.workers, options.workers - 1 ) )
 
 # Set up (Py)ROOT.
 import ROOT
 ROOT.xAOD.Init().ignore()
 
-# Set up the sample handler object.
 import os
+import fnmatch
+import hashlib
+
+def countEntries( path ):
+    """Entries of the CollectionTree, None if the file or the tree cannot be read"""
+    f = ROOT.TFile.Open( path )
+    if not f or f.IsZombie():
+        return None
+    tree = f.Get( 'CollectionTree' )
+    nEntries = tree.GetEntries() if tree else None
+    f.Close()
+    return nEntries
+
+def readMetadataCache( cacheFile ):
+    """path -> ( size, mtime, entries )"""
+    cache = {}
+    if os.path.exists( cacheFile ):
+        with open( cacheFile ) as f:
+            for line in f:
+                fields = line.rstrip( '\n' ).split( '\t' )
+                # older caches carry a fifth checksum column, it is not needed
+                if len( fields ) >= 4 and not line.startswith( '#' ):
+                    cache[ fields[0] ] = ( int( fields[1] ), int( fields[2] ), int( fields[3] ) )
+    return cache
+
+def writeMetadataCache( cacheFile, metadata ):
+    cacheDir = os.path.dirname( cacheFile )
+    if cacheDir and not os.path.isdir( cacheDir ):
+        os.makedirs( cacheDir )
+    with open( cacheFile + '.tmp', 'w' ) as f:
+        f.write( '# path\tsize\tmtime\tentries\n' )
+        for path in sorted( metadata ):
+            f.write( '%s\t%d\t%d\t%d\n' % ( ( path, ) + metadata[ path ] ) )
+    os.rename( cacheFile + '.tmp', cacheFile )
+
+def inputMetadata( inputDir, pattern, cacheFile ):
+    """Entries of the input files, only files that are new or changed (size or mtime) are opened"""
+    cache = readMetadataCache( cacheFile )
+    metadata = {}
+    nOpened = nCached = 0
+    for root, dirs, files in os.walk( inputDir ):
+        for name in fnmatch.filter( files, pattern ):
+            path = os.path.abspath( os.path.join( root, name ) )
+            st = os.stat( path )
+            cached = cache.get( path )
+            if cached and cached[0] == st.st_size and cached[1] == int( st.st_mtime ):
+                metadata[ path ] = cached
+                nCached += 1
+            else:
+                nEntries = countEntries( path )
+                nOpened += 1
+                if nEntries is None:
+                    # not cached, so that the file is tried again in the next run
+                    print( 'WARNING: cannot read CollectionTree of %s, skipping it' % path )
+                    continue
+                metadata[ path ] = ( st.st_size, int( st.st_mtime ), nEntries )
+    if nOpened or set( metadata ) != set( cache ):
+        writeMetadataCache( cacheFile, metadata )
+    print( 'Input metadata: %d files, %d read from %s' % ( len( metadata ), nCached, cacheFile ) )
+    return metadata
+
+def balancedSplits( entries, nSplits ):
+    """Greedy split of the inputs (input -> entries) into nSplits lists with similar numbers of entries"""
+    splits = [ [ 0, [] ] for i in range( nSplits ) ]
+    for key in sorted( entries, key = lambda k: ( -entries[ k ], k ) ):
+        split = min( splits, key = lambda s: s[0] )
+        split[0] += entries[ key ]
+        split[1].append( key )
+    return splits
+
+def replayFiles( replay ):
+    """Output files holding the EventList trees of a previous run"""
+    import glob
+    if os.path.isdir( replay ):
+        return sorted( glob.glob( os.path.join( os.path.abspath( replay ), 'data-TruthAna', '*.root' ) ) )
+    return [ os.path.abspath( replay ) ]
+
+def replayEntries( files ):
+    """Sorted selected entries per input file, keyed on the full name recorded by the algorithm"""
+    chain = ROOT.TChain( 'EventList' )
+    for f in files:
+        chain.Add( f )
+    entries = {}
+    for event in chain:
+        entries.setdefault( str( event.File ), set() ).add( event.Entry )
+    return dict( ( path, sorted( e ) ) for path, e in entries.items() )
+
+def entryRanges( entries, nMaxRanges ):
+    """Splits sorted entries into at most nMaxRanges ( first, last ) ranges at the largest gaps,
+    same as TruthAna::entryRanges"""
+    if not entries:
+        return []
+    cuts = [ i for i in range( 1, len( entries ) ) if entries[ i ] - entries[ i - 1 ] > 1 ]
+    cuts = sorted( sorted( cuts, key = lambda i: ( entries[ i - 1 ] - entries[ i ], i ) )[ : max( 0, nMaxRanges - 1 ) ] )
+    bounds = [ 0 ] + cuts + [ len( entries ) ]
+    return [ ( entries[ bounds[ k ] ], entries[ bounds[ k + 1 ] - 1 ] ) for k in range( len( bounds ) - 1 ) ]
+
+replayEventLists = replayFiles( options.replay ) if options.replay else []
+if replayEventLists:
+    # a few entries here and there, prefetching would read the skipped ones again
+    options.cache_size = 0
+
+# Set up the sample handler object.
 sh = ROOT.SH.SampleHandler()
 sh.setMetaString( 'nc_tree', 'CollectionTree' )
 inputFilePath = options.input_dir
-ROOT.SH.ScanDir().filePattern( options.file_pattern ).scan( sh, inputFilePath )
+nInputEntries = 0
+if replayEventLists:
+    # one sample per entry range of the recorded input files, EventLoop only walks
+    # the entries from the first to the last selected one of each range
+    ranges = {}
+    nSelected = 0
+    for path, entries in replayEntries( replayEventLists ).items():
+        nSelected += len( entries )
+        for first, last in entryRanges( entries, options.replay_max_ranges ):
+            ranges[ ( path, first, last ) ] = last - first + 1
+    if options.workers > max( 1, len( ranges ) ):
+        parser.error( '--workers %d is more than the %d replay ranges' % ( options.workers, len( ranges ) ) )
+    sampleName = os.path.basename( os.path.normpath( inputFilePath ) )
+    rangeIndex = dict( ( key, k ) for k, key in enumerate( sorted( ranges ) ) )
+    nSamples = 0
+    for i, ( nEntries, keys ) in enumerate( balancedSplits( ranges, max( 1, options.workers ) ) ):
+        if options.worker_index >= 0 and i != options.worker_index:
+            continue
+        for path, first, last in sorted( keys ):
+            sample = ROOT.SH.SampleLocal( '%s.replay%d' % ( sampleName, rangeIndex[ ( path, first, last ) ] ) )
+            sample.add( path )
+            sample.meta().setDouble( ROOT.SH.MetaFields.numEvents, last - first + 1 )
+            sample.meta().setDouble( ROOT.EL.Job.optSkipEvents, first )
+            sample.meta().setDouble( ROOT.EL.Job.optMaxEvents, last - first + 1 )
+            sh.add( sample )
+            nSamples += 1
+        nInputEntries += nEntries
+    print( 'Replaying %d events, walking %d entries in %d samples' % ( nSelected, nInputEntries, nSamples ) )
+elif options.metadata_cache == 'none':
+    ROOT.SH.ScanDir().filePattern( options.file_pattern ).scan( sh, inputFilePath )
+else:
+    cacheFile = options.metadata_cache
+    if not cacheFile:
+        key = hashlib.md5( ( os.path.abspath( inputFilePath ) + '|' + options.file_pattern ).encode() ).hexdigest()
+        cacheFile = os.path.join( os.path.expanduser( '~' ), '.cache', 'TruthAnalysis', key + '.txt' )
+    metadata = inputMetadata( inputFilePath, options.file_pattern, cacheFile )
+    if options.workers > max( 1, len( metadata ) ):
+        # a split without files would run an empty sample
+        parser.error( '--workers %d is more than the %d input files' % ( options.workers, len( metadata ) ) )
+    sampleName = os.path.basename( os.path.normpath( inputFilePath ) )
+    entries = dict( ( p, m[2] ) for p, m in metadata.items() )
+    for i, ( nEntries, paths ) in enumerate( balancedSplits( entries, max( 1, options.workers ) ) ):
+        if options.worker_index >= 0 and i != options.worker_index:
+            continue
+        sample = ROOT.SH.SampleLocal( sampleName if options.workers <= 1 else '%s.split%d' % ( sampleName, i ) )
+        for path in sorted( paths ):
+            sample.add( path )
+        sample.meta().setDouble( ROOT.SH.MetaFields.numEvents, nEntries )
+        sh.add( sample )
+        nInputEntries += nEntries
 sh.printContent()
 
-# Create an EventLoop job.
-job = ROOT.EL.Job()
-job.outputAdd ( ROOT.EL.OutputStream ('TruthAna') )
-job.sampleHandler( sh )
-if options.n_events > 0:
-    job.options().setDouble( ROOT.EL.Job.optMaxEvents, options.n_events )
-job.options().setString( ROOT.EL.Job.optSubmitDirMode, 'unique-link')
+def makeJob( maxEvents, cacheBranches ):
+    """Create an EventLoop job running the analysis algorithm"""
+    job = ROOT.EL.Job()
+    job.outputAdd ( ROOT.EL.OutputStream ('TruthAna') )
+    job.sampleHandler( sh )
+    if maxEvents > 0:
+        job.options().setDouble( ROOT.EL.Job.optMaxEvents, maxEvents )
+    job.options().setString( ROOT.EL.Job.optSubmitDirMode, 'unique-link')
+
+    # Input I/O: read cache and xAOD access mode
+    job.options().setDouble( ROOT.EL.Job.optCacheSize, options.cache_size )
+    job.options().setDouble( ROOT.EL.Job.optCacheLearnEntries, options.cache_learn_entries )
+    if options.access_mode == 'branch':
+        job.options().setString( ROOT.EL.Job.optXaodAccessMode, ROOT.EL.Job.optXaodAccessMode_branch )
+    else:
+        job.options().setString( ROOT.EL.Job.optXaodAccessMode, ROOT.EL.Job.optXaodAccessMode_class )
+    if options.read_stats or options.auto_prune:
+        job.options().setDouble( ROOT.EL.Job.optXAODReadStats, 1 )
 
-# Create the algorithm's configuration.
-from AnaAlgorithm.DualUseConfig import createAlgorithm
-alg = createAlgorithm ( 'TruthAnaHHbbtautau', 'AnalysisAlg' )
-alg.OutputLevel = ROOT.MSG.INFO
-alg.RootStreamName = 'TruthAna'
+    # Create the algorithm's configuration.
+    from AnaAlgorithm.DualUseConfig import createAlgorithm
+    alg = createAlgorithm ( 'TruthAnaHHbbtautau', 'AnalysisAlg' )
+    alg.OutputLevel = ROOT.MSG.INFO
+    alg.RootStreamName = 'TruthAna'
+    alg.CacheBranches = cacheBranches
+    alg.CutExpressions = options.cuts
+    alg.HiggsContainer = options.higgs_container
+    alg.BjetPairing = options.bjet_pairing
+    alg.BjetPairingMass = options.bjet_pairing_mass
+    alg.BjetPairingMaxDR = options.bjet_pairing_max_dr
+    alg.ReplayEventLists = replayEventLists
+    if options.trace_file:
+        alg.DecisionTraceFile = os.path.abspath( options.trace_file )
+    alg.SamplingFraction = options.sampling_fraction
+    alg.SamplingSeed = options.sampling_seed
+    alg.EarlyStopPrecision = options.target_precision
+    if options.precision_cuts:
+        alg.EarlyStopCuts = options.precision_cuts
+    if options.monitor_file:
+        alg.MonitorFile = os.path.abspath( options.monitor_file )
+        alg.MonitorInterval = options.monitor_interval
+        if maxEvents > 0:
+            alg.MonitorTotalEvents = maxEvents
+        elif nInputEntries > 0:
+            alg.MonitorTotalEvents = nInputEntries
 
-# Add our algorithm to the job
-job.algsAdd( alg )
+    # Add our algorithm to the job
+    job.algsAdd( alg )
+    return job
+
+def treeBranches():
+    """Top-level branches of the input tree, the only names TTreeCache::AddBranch matches"""
+    f = ROOT.TFile.Open( sh.at( 0 ).fileName( 0 ) )
+    tree = f.Get( 'CollectionTree' )
+    names = set( b.GetName() for b in tree.GetListOfBranches() )
+    f.Close()
+    return names
+
+def readBranches():
+    """Input tree branches read so far, from the xAOD read statistics"""
+    stats = ROOT.xAOD.IOStats.instance().stats()
+    read = set()
+    for container in stats.containers():
+        if container.second.readEntries() > 0:
+            read.add( str( container.first ) )
+    for aux in stats.branches():
+        for branch in aux.second:
+            if branch and branch.readEntries() > 0:
+                # the name already carries the container prefix
+                read.add( str( branch.name() ) )
+
+    # map the statistics names onto the tree: containers are 'Key', static aux
+    # variables live inside 'KeyAux.' and dynamic ones in their own 'KeyAuxDyn.var'
+    treeNames = treeBranches()
+    branches = set()
+    unmatched = []
+    for name in sorted( read ):
+        candidates = [ name, name + '.', name.replace( 'Aux.', 'AuxDyn.', 1 ) ]
+        match = [ c for c in candidates if c in treeNames ]
+        if not match and '.' in name:
+            match = [ t for t in treeNames if t.endswith( '.' ) and name.startswith( t ) ]
+        if match:
+            branches.update( match )
+        else:
+            unmatched.append( name )
+    if unmatched:
+        print( 'WARNING: %d read variables have no input branch: %s' % ( len( unmatched ), ', '.join( unmatched ) ) )
+    return sorted( branches )
+
+# Branches to restrict the read cache to
+cacheBranches = []
+if options.cache_branches:
+    with open( options.cache_branches ) as f:
+        cacheBranches = [ l.strip() for l in f if l.strip() ]
+elif options.auto_prune:
+    pruneDir = options.submission_dir + '_readstats'
+    ROOT.EL.DirectDriver().submit( makeJob( options.prune_events, [] ), pruneDir )
+    cacheBranches = readBranches()
+    with open( os.path.join( pruneDir, 'cacheBranches.txt' ), 'w' ) as f:
+        f.write( '\n'.join( cacheBranches ) + '\n' )
+    print( 'Caching %d branches read in the first %d events' % ( len( cacheBranches ), options.prune_events ) )
+
+job = makeJob( options.n_events, cacheBranches )
 
 # Run the job using the direct driver.
 driver = ROOT.EL.DirectDriver()
 driver.submit( job, options.submission_dir )
+
+if options.read_stats:
+    ROOT.xAOD.IOStats.instance().stats().Print( 'Summary' )
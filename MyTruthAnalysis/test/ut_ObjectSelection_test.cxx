@@ -0,0 +1,104 @@
+// Compares TruthAna::EtaPhiGrid and TruthAna::IndexMask with brute-force look-ups on random inputs
+
+// My class
+#include "MyTruthAnalysis/ObjectSelection.h"
+
+// ROOT
+#include <TMath.h>
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+  unsigned checkGrid(std::mt19937 &rng, double cellSize, double etaMax)
+  {
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    TruthAna::EtaPhiGrid grid(cellSize, etaMax);
+    unsigned nFailures = 0;
+    for (int iEvent = 0; iEvent < 2000; ++iEvent)
+    {
+      // objects beyond etaMax and phi outside (-pi, pi] must be found as well
+      std::vector<double> vEta, vPhi;
+      const int nObjects = iEvent % 30;
+      grid.clear();
+      for (int i = 0; i < nObjects; ++i)
+      {
+        vEta.push_back(2.4 * etaMax * (uniform(rng) - 0.5));
+        vPhi.push_back(4 * TMath::Pi() * (uniform(rng) - 0.5));
+        grid.add(vEta.back(), vPhi.back());
+      }
+      grid.build();
+
+      for (int iQuery = 0; iQuery < 20; ++iQuery)
+      {
+        const double eta = 2.4 * etaMax * (uniform(rng) - 0.5);
+        const double phi = 4 * TMath::Pi() * (uniform(rng) - 0.5);
+        // from well below the cell size up to a reach that wraps around in phi
+        const double dR = 4 * uniform(rng);
+
+        std::vector<std::size_t> vExpected, vFound;
+        for (int i = 0; i < nObjects; ++i)
+          if (TruthAna::deltaR(eta, phi, vEta[i], vPhi[i]) < dR)
+            vExpected.push_back(i);
+        grid.forEachWithin(eta, phi, dR, [&vFound](std::size_t i) { vFound.push_back(i); });
+        std::sort(vFound.begin(), vFound.end());
+
+        if (vFound != vExpected || grid.anyWithin(eta, phi, dR) != !vExpected.empty())
+        {
+          std::cerr << "grid (cell " << cellSize << ", eta max " << etaMax << ") event " << iEvent
+                    << ": found " << vFound.size() << " objects within " << dR << " of (" << eta << ", " << phi
+                    << "), expected " << vExpected.size() << '\n';
+          ++nFailures;
+        }
+      }
+    }
+    return nFailures;
+  }
+
+  unsigned checkMask(std::mt19937 &rng)
+  {
+    std::uniform_int_distribution<std::size_t> index(0, 299);
+    TruthAna::IndexMask mask;
+    unsigned nFailures = 0;
+    for (int iEvent = 0; iEvent < 2000; ++iEvent)
+    {
+      // indices past the reset size have to grow the mask
+      const std::size_t n = iEvent % 200;
+      mask.reset(n);
+      std::set<std::size_t> expected;
+      for (int i = 0; i < iEvent % 40; ++i)
+      {
+        const std::size_t k = index(rng);
+        mask.insert(k);
+        expected.insert(k);
+      }
+      for (std::size_t k = 0; k < 400; ++k)
+      {
+        if (mask.contains(k) != (expected.count(k) > 0))
+        {
+          std::cerr << "mask event " << iEvent << ": contains(" << k << ") is " << mask.contains(k) << '\n';
+          ++nFailures;
+        }
+      }
+    }
+    return nFailures;
+  }
+}
+
+int main()
+{
+  std::mt19937 rng(20261019);
+  unsigned nFailures = 0;
+  for (double cellSize : {0.2, 0.4, 1.0, 2.5})
+    for (double etaMax : {2.5, 5.0})
+      nFailures += checkGrid(rng, cellSize, etaMax);
+  nFailures += checkMask(rng);
+
+  std::cout << nFailures << " failures\n";
+  return nFailures == 0 ? 0 : 1;
+}
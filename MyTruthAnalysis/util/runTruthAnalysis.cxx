@@ -0,0 +1,325 @@
+// Compiled steering of the truth analysis, the same job as share/RunTruthAnalysis.py
+// without the PyROOT start-up cost. Usage: runTruthAnalysis --help
+
+// AsgTools
+#include <AsgTools/MessageCheck.h>
+
+// EventLoop
+#include <AnaAlgorithm/AnaAlgorithmConfig.h>
+#include <EventLoop/DirectDriver.h>
+#include <EventLoop/Job.h>
+#include <EventLoop/LocalDriver.h>
+#include <EventLoop/OutputStream.h>
+#include <SampleHandler/MetaFields.h>
+#include <SampleHandler/SampleHandler.h>
+#include <SampleHandler/SampleLocal.h>
+#include <SampleHandler/ScanDir.h>
+#include <xAODRootAccess/Init.h>
+
+// My class
+#include "MyTruthAnalysis/AllocationCounter.h"
+#include "MyTruthAnalysis/EventList.h"
+
+// ROOT
+#include <TSystem.h>
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// counting global operator new, TruthAnaBase reports the allocations of the event loop
+void *operator new(std::size_t nBytes)
+{
+  TruthAna::countAllocation();
+  if (void *p = std::malloc(nBytes ? nBytes : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](std::size_t nBytes) { return ::operator new(nBytes); }
+void *operator new(std::size_t nBytes, const std::nothrow_t &) noexcept
+{
+  TruthAna::countAllocation();
+  return std::malloc(nBytes ? nBytes : 1);
+}
+void *operator new[](std::size_t nBytes, const std::nothrow_t &tag) noexcept { return ::operator new(nBytes, tag); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+  struct Options
+  {
+    std::string sSubmissionDir = "submitDir";
+    std::string sInputDir = "/scratchfs/atlas/zhangbw/EVNT/mc16_13TeV.345835.aMcAtNloHerwig7EvtGen_UEEE5_CTEQ6L1_CT10ME_hh_ttbb_hh.merge.DAOD_TRUTH1.root/";
+    std::string sFilePattern = "DAOD_TRUTH1.test.pool.*.root";
+    long long nEvents = -1;
+    std::string sDriver = "direct";
+    std::string sMetadataCache;
+    double fCacheSize = 10 * 1024 * 1024;
+    double fCacheLearnEntries = 20;
+    std::string sReplay;
+    std::size_t nReplayMaxRanges = 8;
+    std::vector<std::pair<std::string, std::string>> vProperties;
+  };
+
+  void usage(const char *sProgram)
+  {
+    std::cout << "Usage: " << sProgram << " [options]\n"
+              << "  -s, --submission-dir DIR     Submission directory for EventLoop (submitDir)\n"
+              << "  -i, --input-dir DIR          Path to input TRUTH1 files\n"
+              << "  -p, --file-pattern PATTERN   Pattern of the input files for SampleHandler\n"
+              << "  -n, --n-events N             Number of events to run (all)\n"
+              << "  -d, --driver NAME            EventLoop driver: direct or local (direct)\n"
+              << "  -m, --metadata-cache FILE    Take the input files from a RunTruthAnalysis.py metadata cache\n"
+              << "      --cache-size BYTES       Size of the input TTreeCache, 0 to disable (10 MB)\n"
+              << "      --cache-learn-entries N  Number of entries the TTreeCache learns from (20)\n"
+              << "  -r, --replay PATH            Submission directory or output file of a previous run, only its\n"
+              << "                               selected events are processed, without TTreeCache and --n-events\n"
+              << "      --replay-max-ranges N    Entry ranges per input file a replay is split into (8)\n"
+              << "  -o, --property NAME=VALUE    Set an algorithm property, can be repeated\n"
+              << "  -h, --help                   Print this message\n";
+  }
+
+  bool parseOptions(int argc, char *argv[], Options &options)
+  {
+    enum { OPT_CACHE_SIZE = 1000, OPT_CACHE_LEARN_ENTRIES, OPT_REPLAY_MAX_RANGES };
+    const option longOptions[] = {
+        {"submission-dir", required_argument, nullptr, 's'},
+        {"input-dir", required_argument, nullptr, 'i'},
+        {"file-pattern", required_argument, nullptr, 'p'},
+        {"n-events", required_argument, nullptr, 'n'},
+        {"driver", required_argument, nullptr, 'd'},
+        {"metadata-cache", required_argument, nullptr, 'm'},
+        {"cache-size", required_argument, nullptr, OPT_CACHE_SIZE},
+        {"cache-learn-entries", required_argument, nullptr, OPT_CACHE_LEARN_ENTRIES},
+        {"replay", required_argument, nullptr, 'r'},
+        {"replay-max-ranges", required_argument, nullptr, OPT_REPLAY_MAX_RANGES},
+        {"property", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}};
+
+    int c;
+    while ((c = getopt_long(argc, argv, "s:i:p:n:d:m:r:o:h", longOptions, nullptr)) != -1)
+    {
+      switch (c)
+      {
+      case 's': options.sSubmissionDir = optarg; break;
+      case 'i': options.sInputDir = optarg; break;
+      case 'p': options.sFilePattern = optarg; break;
+      case 'n': options.nEvents = std::atoll(optarg); break;
+      case 'd': options.sDriver = optarg; break;
+      case 'm': options.sMetadataCache = optarg; break;
+      case OPT_CACHE_SIZE: options.fCacheSize = std::atof(optarg); break;
+      case OPT_CACHE_LEARN_ENTRIES: options.fCacheLearnEntries = std::atof(optarg); break;
+      case 'r': options.sReplay = optarg; break;
+      case OPT_REPLAY_MAX_RANGES: options.nReplayMaxRanges = std::max(1, std::atoi(optarg)); break;
+      case 'o':
+      {
+        const std::string sProperty = optarg;
+        const std::size_t iEqual = sProperty.find('=');
+        if (iEqual == std::string::npos)
+        {
+          std::cerr << "expected NAME=VALUE for --property, got " << sProperty << '\n';
+          return false;
+        }
+        if (sProperty.compare(0, iEqual, "ReplayEventLists") == 0)
+        {
+          // the input and the read cache have to follow the event lists too
+          std::cerr << "use --replay instead of setting ReplayEventLists\n";
+          return false;
+        }
+        options.vProperties.emplace_back(sProperty.substr(0, iEqual), sProperty.substr(iEqual + 1));
+        break;
+      }
+      case 'h': usage(argv[0]); std::exit(EXIT_SUCCESS);
+      default: usage(argv[0]); return false;
+      }
+    }
+    if (options.sDriver != "direct" && options.sDriver != "local")
+    {
+      std::cerr << "unknown driver " << options.sDriver << '\n';
+      return false;
+    }
+    return true;
+  }
+
+  /// name of the input directory
+  std::string sampleName(const Options &options)
+  {
+    return gSystem->BaseName(options.sInputDir.substr(0, options.sInputDir.find_last_not_of('/') + 1).c_str());
+  }
+
+  /// one sample with the files of a metadata cache written by RunTruthAnalysis.py
+  bool readMetadataCache(const Options &options, SH::SampleHandler &sh)
+  {
+    std::ifstream cache(options.sMetadataCache);
+    if (!cache)
+    {
+      std::cerr << "cannot read the metadata cache " << options.sMetadataCache << '\n';
+      return false;
+    }
+
+    auto sample = std::make_unique<SH::SampleLocal>(sampleName(options));
+    double fEntries = 0;
+    std::string sLine;
+    while (std::getline(cache, sLine))
+    {
+      if (sLine.empty() || sLine[0] == '#')
+        continue;
+      // path, size, mtime, entries (and a checksum in older caches)
+      std::istringstream fields(sLine);
+      std::string sPath, sSize, sMTime, sEntries;
+      if (!std::getline(fields, sPath, '\t') || !std::getline(fields, sSize, '\t') ||
+          !std::getline(fields, sMTime, '\t') || !std::getline(fields, sEntries, '\t'))
+        continue;
+      sample->add(sPath);
+      fEntries += std::atof(sEntries.c_str());
+    }
+    sample->meta()->setDouble(SH::MetaFields::numEvents, fEntries);
+    sh.add(sample.release());
+    return true;
+  }
+
+  /// output files holding the EventList trees of a previous run, as absolute paths
+  std::vector<std::string> replayFiles(const std::string &sReplay)
+  {
+    const std::string sPath = sReplay[0] == '/' ? sReplay : std::string(gSystem->WorkingDirectory()) + "/" + sReplay;
+    const std::string sDir = sPath + "/data-TruthAna";
+    void *dir = gSystem->OpenDirectory(sDir.c_str());
+    if (!dir)
+      return {sPath};
+    std::vector<std::string> vFiles;
+    while (const char *sEntry = gSystem->GetDirEntry(dir))
+    {
+      const std::string sName = sEntry;
+      if (sName.size() > 5 && sName.compare(sName.size() - 5, 5, ".root") == 0)
+        vFiles.push_back(sDir + "/" + sName);
+    }
+    gSystem->FreeDirectory(dir);
+    std::sort(vFiles.begin(), vFiles.end());
+    return vFiles;
+  }
+
+  /// one sample per entry range of each recorded input file, EventLoop then only walks
+  /// the entries from the first to the last selected one of each range
+  bool addReplaySamples(const Options &options, const std::vector<std::string> &vFiles, SH::SampleHandler &sh)
+  {
+    std::map<std::string, std::vector<long long>> mapEntries;
+    std::string sError;
+    if (!TruthAna::readEventLists(vFiles, mapEntries, sError))
+    {
+      std::cerr << sError << '\n';
+      return false;
+    }
+
+    std::size_t nSamples = 0, nSelected = 0;
+    long long nWalked = 0;
+    for (const auto &p : mapEntries)
+    {
+      nSelected += p.second.size();
+      for (const auto &range : TruthAna::entryRanges(p.second, options.nReplayMaxRanges))
+      {
+        const double fEntries = range.second - range.first + 1;
+        auto sample = std::make_unique<SH::SampleLocal>(sampleName(options) + ".replay" + std::to_string(nSamples++));
+        sample->add(p.first);
+        sample->meta()->setDouble(SH::MetaFields::numEvents, fEntries);
+        sample->meta()->setDouble(EL::Job::optSkipEvents, range.first);
+        sample->meta()->setDouble(EL::Job::optMaxEvents, fEntries);
+        sh.add(sample.release());
+        nWalked += range.second - range.first + 1;
+      }
+    }
+    std::cout << "Replaying " << nSelected << " events of " << mapEntries.size() << " input files, walking "
+              << nWalked << " entries in " << nSamples << " samples\n";
+    return true;
+  }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  ANA_CHECK_SET_TYPE(int);
+  using namespace asg::msgUserCode;
+
+  Options options;
+  if (!parseOptions(argc, argv, options))
+    return EXIT_FAILURE;
+
+  ANA_CHECK(xAOD::Init());
+  TruthAna::enableAllocationCounting();
+
+  // Set up the sample handler object.
+  SH::SampleHandler sh;
+  sh.setMetaString("nc_tree", "CollectionTree");
+  std::vector<std::string> vReplayFiles;
+  if (!options.sReplay.empty())
+  {
+    vReplayFiles = replayFiles(options.sReplay);
+    if (!addReplaySamples(options, vReplayFiles, sh))
+      return EXIT_FAILURE;
+    // a few entries here and there, prefetching would read the skipped ones again
+    options.fCacheSize = 0;
+  }
+  else if (options.sMetadataCache.empty())
+  {
+    SH::ScanDir().filePattern(options.sFilePattern).scan(sh, options.sInputDir);
+  }
+  else if (!readMetadataCache(options, sh))
+  {
+    return EXIT_FAILURE;
+  }
+  sh.print();
+
+  // Create an EventLoop job.
+  EL::Job job;
+  job.outputAdd(EL::OutputStream("TruthAna"));
+  job.sampleHandler(sh);
+  if (options.nEvents > 0)
+    job.options()->setDouble(EL::Job::optMaxEvents, options.nEvents);
+  job.options()->setString(EL::Job::optSubmitDirMode, "unique-link");
+  job.options()->setDouble(EL::Job::optCacheSize, options.fCacheSize);
+  job.options()->setDouble(EL::Job::optCacheLearnEntries, options.fCacheLearnEntries);
+  job.options()->setString(EL::Job::optXaodAccessMode, EL::Job::optXaodAccessMode_branch);
+
+  // Create the algorithm's configuration.
+  EL::AnaAlgorithmConfig alg;
+  alg.setType("TruthAnaHHbbtautau");
+  alg.setName("AnalysisAlg");
+  ANA_CHECK(alg.setProperty("OutputLevel", MSG::INFO));
+  ANA_CHECK(alg.setProperty("RootStreamName", "TruthAna"));
+  if (!vReplayFiles.empty())
+  {
+    ANA_CHECK(alg.setProperty("ReplayEventLists", vReplayFiles));
+  }
+  for (const auto &property : options.vProperties)
+  {
+    alg.setPropertyFromString(property.first, property.second);
+  }
+
+  // Add our algorithm to the job
+  job.algsAdd(alg);
+
+  // Run the job using the chosen driver.
+  if (options.sDriver == "local")
+  {
+    EL::LocalDriver driver;
+    driver.submit(job, options.sSubmissionDir);
+  }
+  else
+  {
+    EL::DirectDriver driver;
+    driver.submit(job, options.sSubmissionDir);
+  }
+
+  return EXIT_SUCCESS;
+}